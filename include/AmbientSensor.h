@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define AMBIENT_MAX 4095 // Full scale of read()
+
+// Light sensor on an analog pin
+//  On SAMD the ADC runs free in the background and averages 16 conversions
+//  in hardware per result, so read() only picks up the latest 12-bit result
+//  and never waits for a conversion. Elsewhere it falls back to analogRead().
+//  The sensor then owns the ADC, analogRead() must not be used on other pins.
+class AmbientSensor
+{
+public:
+    void begin(uint8_t pin);
+
+    // Latest averaged reading, 0..AMBIENT_MAX
+    uint16_t read();
+
+private:
+    uint8_t m_pin;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <FastLED.h>
+
+#include "EffectEngine.h"
+#include "NoiseField.h"
+#include "PanelMap.h"
+
+// Background effects
+//  All of them visit LEDs in strip order through the panel's inverse map,
+//  so leds[] is written front to back on any panel size, and scale their
+//  output to EFFECT_LEVEL.
+enum background_effect_t
+{
+    EFFECT_RAINBOW,   // Rotating noise rainbow
+    EFFECT_PLASMA,    // Sum of sine waves
+    EFFECT_FIRE,      // Heat rising from the bottom row
+    EFFECT_STARFIELD, // Stars flying out from the centre
+    EFFECT_TWINKLE,   // Random LEDs flaring and fading
+    EFFECT_SOLID,     // One colour from the hue
+    EFFECTS
+};
+
+extern const Effect backgroundEffects[EFFECTS];
+
+// Smallest square side holding leds
+constexpr uint16_t effectSquareSide(uint16_t leds, uint16_t side = 1)
+{
+    return side * side >= leds ? side : effectSquareSide(leds, side + 1);
+}
+
+// Noise lattice points per side, enough for a square panel of
+// EFFECT_MAX_LEDS (9 for 16 x 16, 32 for 64 x 64). The rainbow's state holds
+// the lattice, so it is sized with the arena. begin() uses as much of it as
+// the panel needs, and panels it does not cover, such as long strips, use
+// the exact walk.
+#define RAINBOW_LATTICE noiseFieldSide(rainbowSpan(effectSquareSide(EFFECT_MAX_LEDS)))
+
+// Rainbow walk
+//  Rotates the grid through 2D noise, 1024 steps per turn, dimmed to sit
+//  behind the words.
+//  The rotation is computed once per frame with 16-bit table sin/cos, then
+//  each LED's rotated position (Q15) is the origin plus its x and y steps.
+//  Positions come straight from the LED's grid point rather than being
+//  stepped, so any wiring order costs the same.
+template <typename Sample>
+inline void rainbowKernel(CRGB *leds, const PanelView &panel, uint32_t step, const Sample &sample)
+{
+    uint16_t angle = (step % 1024) << 6;
+    int32_t c = cos16(angle);
+    int32_t s = sin16(angle);
+
+    // Rotated position of grid (0, 0)
+    int32_t x_origin = (panel.width * 32) * c - (panel.height * 32) * s;
+    int32_t y_origin = (panel.height * 32) * c + (panel.width * 32) * s;
+    // One grid step
+    int32_t c8 = 8 * c;
+    int32_t s8 = 8 * s;
+    for (uint16_t i = 0; i < panel.leds; i++)
+    {
+        PanelPoint p = panel.point[i];
+        int32_t x_rot = x_origin + p.x * c8 - p.y * s8;
+        int32_t y_rot = y_origin + p.x * s8 + p.y * c8;
+        CRGB &led = leds[i];
+        led.setHue(sample(x_rot >> 15, y_rot >> 15));
+        led.fadeToBlackBy(255 - EFFECT_LEVEL);
+    }
+}
+
+// Exact, inoise16 for every LED
+inline void rainbowWalk(CRGB *leds, const PanelView &panel, uint32_t step)
+{
+    rainbowKernel(leds, panel, step, [](int32_t x, int32_t y) { return inoise16((uint32_t)x, (uint32_t)y); });
+}
+
+// From a noise field, within NOISE_FIELD_MAX_ERROR of the exact walk
+template <uint8_t N>
+void rainbowWalk(CRGB *leds, const PanelView &panel, uint32_t step, const NoiseField<N> &field)
+{
+    rainbowKernel(leds, panel, step, [&field](int32_t x, int32_t y) { return field.sample(x, y); });
+}
+
+// Largest |x|, |y| the walk samples noise at on this panel
+//  The rotated offset of grid (x, y) is (32 * width + 8x, 32 * height + 8y),
+//  at most 40 * sqrt(2) * the longer side.
+constexpr uint32_t rainbowSpan(uint16_t longer_side)
+{
+    return 60 * longer_side;
+}
+
+inline uint32_t rainbowRadius(const PanelView &panel)
+{
+    return rainbowSpan(panel.width > panel.height ? panel.width : panel.height);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+#define BRIGHTNESS_MEDIAN 5      // Samples in the spike filter, odd
+#define BRIGHTNESS_IIR_SHIFT 3   // Smoothing, the output moves 1/8 of the way per sample
+#define BRIGHTNESS_HYSTERESIS 24 // Change in the smoothed level (of 4095) that moves the output
+
+// Ambient level filter
+//  Median of the last few samples drops spikes, a first order IIR smooths
+//  what is left, and the output only follows once the smoothed level moves
+//  past the hysteresis band, so sensor noise never shows up as shimmer.
+class BrightnessFilter
+{
+public:
+    // Add a 12-bit sample, returns the held level 0..4095
+    uint16_t update(uint16_t sample);
+
+    uint16_t level() const { return m_held; }
+
+private:
+    uint16_t m_window[BRIGHTNESS_MEDIAN];
+    uint8_t m_next = 0;
+    bool m_primed = false;
+    int32_t m_smooth = 0; // Level << 4
+    uint16_t m_held = 0;
+};
+
+// Map a 12-bit level onto min_brightness..255 along the CIE lightness curve,
+// so equal steps of the sensor look like equal steps of brightness
+uint8_t perceptualBrightness(uint16_t level, uint8_t min_brightness);
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define CONSOLE_LINE_MAX 64       // Longest command line, longer lines are dropped
+#define CONSOLE_BYTES_PER_TICK 16 // Input bytes taken per poll()
+
+// Runtime parameter
+//  Numbers are range checked, text values are copied into a buffer of
+//  max bytes. changed() runs after a set and can refuse the new value,
+//  which is then put back.
+enum param_type_t
+{
+    PARAM_U8,
+    PARAM_U16,
+    PARAM_U32,
+    PARAM_TEXT
+};
+
+struct Parameter
+{
+    const char *name;
+    param_type_t type;
+    void *value;
+    uint32_t min;
+    uint32_t max;      // Largest number, or text buffer size
+    bool (*changed)(); // May be nullptr
+    bool read_only;
+};
+
+const Parameter *findParameter(const Parameter *params, uint8_t count, const char *name);
+
+// Parse and store text as the parameter's value, false if refused
+bool setParameter(const Parameter &param, const char *text);
+
+// Whether setParameter() would take text, short of what changed() decides.
+//  Nothing is stored.
+bool checkParameter(const Parameter &param, const char *text);
+
+void printParameter(Print &out, const Parameter &param);
+
+// Value of a number parameter
+uint32_t parameterNumber(const Parameter &param);
+
+// Value as bytes for keeping elsewhere, numbers in memory order at their
+// own width, text without the terminator. Returns the length, 0 if it does
+// not fit in size.
+uint8_t parameterBytes(const Parameter &param, void *buf, uint8_t size);
+
+// Set from bytes as parameterBytes() gives them, checked like setParameter()
+bool setParameterBytes(const Parameter &param, const void *data, uint8_t len);
+
+typedef void (*ParameterSet)(const Parameter &param);
+
+// Console command, args is the rest of the line with leading spaces removed
+struct ConsoleCommand
+{
+    const char *name;
+    const char *help;
+    void (*run)(Print &out, char *args);
+};
+
+// Line console
+//  Takes a few bytes per poll() so typing never holds up a frame, and runs
+//  a command when its line ends. help, get and set are built in, the rest
+//  come from the command table. Nothing is allocated.
+class Console
+{
+public:
+    Console(Stream &in, Print &out, const ConsoleCommand *commands, uint8_t command_count,
+            const Parameter *params, uint8_t param_count)
+        : m_in(in), m_out(out), m_commands(commands), m_command_count(command_count),
+          m_params(params), m_param_count(param_count) {}
+
+    void poll();
+
+    // Called after the console sets a parameter
+    void onSet(ParameterSet listener) { m_on_set = listener; }
+
+private:
+    void execute(char *line);
+    void help();
+    void get(char *args);
+    void set(char *args);
+
+    Stream &m_in;
+    Print &m_out;
+    const ConsoleCommand *m_commands;
+    uint8_t m_command_count;
+    const Parameter *m_params;
+    uint8_t m_param_count;
+    ParameterSet m_on_set = nullptr;
+
+    char m_line[CONSOLE_LINE_MAX];
+    uint8_t m_length = 0;
+    bool m_overflow = false; // Drop the rest of a line that did not fit
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <FastLED.h>
+
+#include "WS2812Encoder.h"
+
+// SERCOM SPI transmitter fed by a DMA channel
+//  Data goes out on the SPI MOSI pin (D11), not LED_PIN.
+class Ws2812Dma
+{
+public:
+    void begin();
+
+    // True while the previous buffer is still being sent
+    bool busy();
+
+    // Start sending len bytes, returns immediately
+    void send(const uint8_t *buf, uint16_t len);
+};
+
+// FastLED controller that sends pre-encoded frames by DMA
+//  Frames are encoded into one buffer while the other is on the wire, so
+//  show() only waits if the previous frame has not finished sending.
+template <uint16_t N>
+class DmaWS2812Controller : public CLEDController
+{
+public:
+    void init() override
+    {
+        m_dma.begin();
+    }
+
+protected:
+    void showColor(const CRGB &data, int nLeds, CRGB scale) override
+    {
+        uint8_t *buf = m_buf[m_back];
+        uint16_t count = nLeds < N ? nLeds : N;
+        for (uint16_t i = 0; i < count; i++)
+        {
+            ws2812Encode(data.raw, 1, scale.raw, buf + i * WS2812_BYTES_PER_PIXEL);
+        }
+        send(count);
+    }
+
+    void show(const CRGB *data, int nLeds, CRGB scale) override
+    {
+        uint16_t count = nLeds < N ? nLeds : N;
+        ws2812Encode((const uint8_t *)data, count, scale.raw, m_buf[m_back]);
+        send(count);
+    }
+
+private:
+    void send(uint16_t count)
+    {
+        uint8_t *buf = m_buf[m_back];
+        uint16_t len = ws2812Reset(buf, count);
+        while (m_dma.busy())
+            ;
+        m_dma.send(buf, len);
+        m_back ^= 1;
+    }
+
+    Ws2812Dma m_dma;
+    uint8_t m_buf[2][WS2812_BUFFER_SIZE(N)];
+    uint8_t m_back = 0;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+
+#define DRIFT_SAMPLES 8
+#define DRIFT_MIN_SAMPLE_S 60      // Shorter intervals are too noisy to use
+#define DRIFT_GOOD_MS 250          // Residual offsets below this stretch the sync interval
+#define DRIFT_BAD_MS 1000          // Residual offsets above this are held back for the next sample to confirm
+#define DRIFT_MIN_INTERVAL_S 3600  // Seconds between syncs with no estimate
+#define DRIFT_MAX_INTERVAL_S 86400 // Seconds between syncs at full confidence
+
+// RTC drift estimate from the offsets measured at each sync
+//  Each sample gives the rate the RTC ran at since the previous sync: the
+//  correction that was applied, less the offset that built up anyway. The
+//  estimate is the mean of recent rates weighted by interval, since longer
+//  intervals are less affected by the offset measurement error. While the
+//  residual offsets stay small the sync interval doubles.
+//
+//  A large residual is held back and the next sync comes soon. If the next
+//  rate agrees with it the drift changed (e.g. temperature) and the
+//  estimate starts over from the two, otherwise it was a bad measurement,
+//  such as a wrong NTP reply, and is dropped as an outlier.
+class DriftEstimator
+{
+public:
+    // offset_ms is true time minus corrected RTC time, measured interval_s
+    // after the previous sync while applied_ppb of correction was in effect
+    void addSample(uint32_t interval_s, int32_t offset_ms, int32_t applied_ppb);
+
+    void reset();
+
+    // Start from an earlier estimate, e.g. one kept over a reset. It counts
+    // as no samples, so the sync interval stays short and the first
+    // measured rate replaces it.
+    void seed(int32_t ppb);
+
+    // RTC rate error in parts per billion, positive when it runs fast
+    int32_t ppb() const { return m_ppb; }
+
+    // Recommended seconds until the next sync
+    uint32_t syncInterval() const { return m_interval_s; }
+
+    uint8_t samples() const { return m_count; }
+    uint32_t outliers() const { return m_outliers; }
+
+private:
+    void push(uint32_t interval_s, int32_t rate);
+
+    uint32_t m_intervals[DRIFT_SAMPLES];
+    int32_t m_rates[DRIFT_SAMPLES]; // ppb
+    uint8_t m_head = 0;
+    uint8_t m_count = 0;
+    int32_t m_ppb = 0;
+    uint32_t m_interval_s = DRIFT_MIN_INTERVAL_S;
+    uint32_t m_suspect_s = 0;  // Interval of the held back sample, 0 for none
+    int32_t m_suspect_ppb = 0; // Its rate
+    uint32_t m_outliers = 0;
+};
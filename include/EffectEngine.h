@@ -0,0 +1,90 @@
+#pragma once
+
+#include <FastLED.h>
+
+#include "PanelMap.h"
+
+#ifndef EFFECT_MAX_LEDS
+#define EFFECT_MAX_LEDS 256 // Largest panel effects with per-LED state are sized for
+#endif
+#ifndef EFFECT_ARENA_SIZE
+#define EFFECT_ARENA_SIZE EFFECT_MAX_LEDS // Bytes of state shared by all effects, only the running one owns it
+#endif
+#define EFFECT_LEVEL 63 // Background scale, keeps the words readable on top
+
+// What an effect gets each frame besides its state
+struct EffectFrame
+{
+    uint32_t step; // Animation step, advances by the animation speed per frame
+    uint8_t hue;   // Base colour, settable from the console
+};
+
+// Background effect
+//  Plain functions, so choosing an effect is one table lookup per frame and
+//  the per-LED loops inside render() are straight code. State lives in the
+//  engine's arena, begin() sets it up when the effect is selected.
+struct Effect
+{
+    const char *name;
+    uint16_t state_size;
+    uint8_t state_align;
+    bool (*begin)(void *state, const PanelView &panel); // May be nullptr, false if the panel is too big
+    void (*render)(void *state, CRGB *leds, const PanelView &panel, const EffectFrame &frame);
+};
+
+#define EFFECT_STATE(T) sizeof(T), alignof(T)
+#define EFFECT_STATELESS 0, 1
+
+// Every effect's state fits the arena, checked where the table is defined
+constexpr bool effectsFitArena(const Effect *effects, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (effects[i].state_size > EFFECT_ARENA_SIZE || effects[i].state_align > 4)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Measured render time, microseconds
+struct EffectCost
+{
+    uint32_t frames;
+    uint16_t last_us;
+    uint16_t mean_us; // Running mean over about 8 frames
+    uint16_t max_us;
+};
+
+// Runs one effect from a table at a time
+class EffectEngine
+{
+public:
+    EffectEngine(const Effect *effects, uint8_t count) : m_effects(effects), m_count(count) {}
+
+    // Switch effect and reset its state, false (keeping the current one)
+    // if it does not exist or cannot run on this panel
+    bool select(uint8_t effect, const PanelView &panel);
+
+    // Render a frame with the current effect and time it
+    void render(CRGB *leds, const PanelView &panel, const EffectFrame &frame);
+
+    uint8_t current() const { return m_current; }
+    uint8_t count() const { return m_count; }
+    const Effect &effect(uint8_t effect) const { return m_effects[effect]; }
+    const EffectCost &cost(uint8_t effect) const { return m_costs[effect]; }
+
+    // One line per effect with its cost, the current one marked
+    void dump(Print &out) const;
+
+private:
+    static const uint8_t MAX_EFFECTS = 16;
+
+    const Effect *m_effects;
+    uint8_t m_count;
+    uint8_t m_current = 0;
+    bool m_ready = false; // begin() has run for the current effect
+    EffectCost m_costs[MAX_EFFECTS] = {};
+    alignas(4) uint8_t m_arena[EFFECT_ARENA_SIZE];
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Word clock face
+//  A face is a namespace in include/faces/ holding only constexpr data:
+//      WIDTH, HEIGHT            grid size
+//      letters[HEIGHT]          the printed letters, one string per row
+//      enum { ..., WORDS }      its words
+//      words[WORDS]             where each word is spelled
+//      ALWAYS                   words lit all the time ("IT IS")
+//      slots[12]                phrase for each 5 minute slot
+//      hours[12]                hour word for each hour % 12
+//  WordMask.h compiles the selected face into LED masks at build time, so
+//  adding a language is adding a face file and listing it in Faces.h.
+
+// Word position, text must match the letters it covers
+struct FaceWord
+{
+    uint8_t row;
+    uint8_t col;
+    const char *text;
+};
+
+// Phrase for one 5 minute slot
+struct FaceSlot
+{
+    uint32_t words;        // FACE_WORD bits
+    uint8_t hour_offset;   // Phrase names the hour this many hours ahead
+    const uint8_t *hours;  // Hour words to name it with, usually the face's hours
+};
+
+#define FACE_WORD(W) ((uint32_t)1 << (W))
+#define FACE_WORDS_MAX 32 // Words in a FACE_WORD bitset
+
+// Every row is full width and every word is spelled where it says
+template <size_t W1, size_t H, size_t N>
+constexpr bool faceSpellsWords(const char (&letters)[H][W1], const FaceWord (&words)[N])
+{
+    for (size_t row = 0; row < H; row++)
+    {
+        if (letters[row][W1 - 2] == '\0')
+        {
+            return false;
+        }
+    }
+    for (size_t w = 0; w < N; w++)
+    {
+        const FaceWord &word = words[w];
+        if (word.text[0] == '\0')
+        {
+            return false;
+        }
+        for (size_t i = 0; word.text[i]; i++)
+        {
+            if (word.row >= H || word.col + i >= W1 - 1 || letters[word.row][word.col + i] != word.text[i])
+            {
+                return false;
+            }
+        }
+    }
+    return N <= FACE_WORDS_MAX;
+}
+
+// Slot words and hour words all exist
+constexpr bool faceGrammarValid(const FaceSlot (&slots)[12], uint8_t word_count)
+{
+    uint32_t known = word_count >= FACE_WORDS_MAX ? 0xFFFFFFFF : FACE_WORD(word_count) - 1;
+    for (uint8_t s = 0; s < 12; s++)
+    {
+        if (slots[s].words & ~known)
+        {
+            return false;
+        }
+        for (uint8_t h = 0; h < 12; h++)
+        {
+            if (slots[s].hours[h] >= word_count)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
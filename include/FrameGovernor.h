@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define GOVERNOR_LEVELS 5      // Quality levels, 0 is full quality
+#define GOVERNOR_HOLD_FRAMES 8 // Frames between decisions, lets the means settle
+
+// What each quality level keeps
+struct GovernorLevel
+{
+    uint16_t refresh_ms;      // Time in milliseconds between dithered refreshes
+    uint8_t background_every; // Frames per background render, the rest reuse the last one
+};
+
+// Frame rate and quality governor
+//  Fed the measured cost of every frame (render plus show) and of every
+//  dithered refresh in between. It keeps the CPU share of rendering under
+//  load_pct of the frame period: with headroom the period shrinks toward
+//  min_ms for smoother animation, without it the period grows toward the
+//  deadline, and past that quality steps down one level at a time. Frames
+//  that start more than a deadline after the previous one are counted as
+//  missed.
+class FrameGovernor
+{
+public:
+    void configure(uint16_t deadline_ms, uint16_t min_ms, uint8_t load_pct);
+
+    // A frame started at start_ms and took cost_us to render and show
+    void frameDone(uint32_t start_ms, uint32_t cost_us);
+
+    // A dithered refresh took cost_us. Fed before the first configure(), the
+    // cost picks the level to start at.
+    void refreshDone(uint32_t cost_us);
+
+    // Every show() holds the CPU for at least wire_us, whatever was measured.
+    // Set before the first refreshDone().
+    void setWireUs(uint32_t wire_us) { m_wire_us = wire_us; }
+
+    // Render the background on this frame, or reuse the last one
+    bool backgroundDue() const { return m_frames % levels[m_level].background_every == 0; }
+
+    uint16_t periodMs() const { return m_period_ms; }
+    uint16_t refreshMs() const { return levels[m_level].refresh_ms; }
+    uint8_t backgroundEvery() const { return levels[m_level].background_every; }
+    uint8_t level() const { return m_level; }
+    uint32_t frames() const { return m_frames; }
+    uint32_t missed() const { return m_missed; }
+    uint32_t frameUs() const { return m_frame_us; }
+    uint32_t refreshUs() const { return m_refresh_us; }
+
+    // Level, period, mean costs and missed deadlines
+    void dump(Print &out) const;
+
+    static const GovernorLevel levels[GOVERNOR_LEVELS];
+
+private:
+    // Microseconds of work per frame period at this level
+    uint32_t loadUs(uint8_t level, uint16_t period_ms) const;
+    bool fits(uint8_t level, uint16_t period_ms) const;
+    uint16_t longestMs() const; // Longest period, leaves room for scheduling jitter before the deadline
+    uint8_t startLevel() const;
+    void decide();
+
+    uint16_t m_deadline_ms = 100;
+    uint16_t m_min_ms = 20;
+    uint8_t m_load_pct = 50;
+
+    uint16_t m_period_ms = 100;
+    uint8_t m_level = 0;
+    uint32_t m_frame_us = 0;   // Running means over about 8 samples
+    uint32_t m_refresh_us = 0;
+    uint32_t m_wire_us = 0;    // Least a show() costs, frames and refreshes both do one
+    uint32_t m_last_start_ms = 0;
+    uint32_t m_frames = 0;
+    uint32_t m_missed = 0;
+    uint8_t m_hold = GOVERNOR_HOLD_FRAMES;
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiNINA.h>
+
+#define HTTP_LINE_MAX 128       // Longest request or header line
+#define HTTP_PATH_MAX 32        // Longest path, the query string is dropped
+#define HTTP_BODY_MAX 192       // Largest POST body
+#define HTTP_RESPONSE_MAX 768   // Largest response body
+#define HTTP_HEADER_MAX 128     // Status line and headers
+#define HTTP_READ_PER_POLL 64   // Request bytes taken per poll()
+#define HTTP_WRITE_PER_POLL 256 // Response bytes sent per poll()
+#define HTTP_TIMEOUT_MS 3000    // A request not answered by then is dropped
+
+enum http_method_t
+{
+    HTTP_GET,
+    HTTP_POST,
+    HTTP_OTHER
+};
+
+struct HttpRequest
+{
+    http_method_t method;
+    char path[HTTP_PATH_MAX];
+    char body[HTTP_BODY_MAX + 1]; // Null terminated
+    uint16_t body_length;
+};
+
+// Print into a fixed buffer, what does not fit is dropped and noted
+class BufferPrint : public Print
+{
+public:
+    BufferPrint(char *buf, uint16_t size) : m_buf(buf), m_size(size) {}
+
+    size_t write(uint8_t c) override
+    {
+        if (m_length >= m_size)
+        {
+            m_overflow = true;
+            return 0;
+        }
+        m_buf[m_length++] = c;
+        return 1;
+    }
+    using Print::write;
+
+    uint16_t length() const { return m_length; }
+    bool overflow() const { return m_overflow; }
+
+private:
+    char *m_buf;
+    uint16_t m_size;
+    uint16_t m_length = 0;
+    bool m_overflow = false;
+};
+
+// JSON object written straight to a Print
+class JsonObject
+{
+public:
+    JsonObject(Print &out) : m_out(out) { m_out.print('{'); }
+
+    void addInt(const char *name, int32_t value);
+    void addUint(const char *name, uint32_t value);
+    void addBool(const char *name, bool value);
+    void addText(const char *name, const char *text);
+    void end() { m_out.print('}'); }
+
+private:
+    void key(const char *name);
+
+    Print &m_out;
+    bool m_first = true;
+};
+
+// Split the next name=value pair off a form body, decoding it in place.
+// Returns false when there are no more.
+bool httpFormNext(char *&cursor, char *&name, char *&value);
+
+// Writes the response body for a request, returns the status code
+typedef uint16_t (*HttpHandler)(HttpRequest &request, Print &body);
+
+// HTTP/1.0 style server, one request per connection
+//  poll() moves one client along by at most HTTP_READ_PER_POLL bytes of
+//  request or HTTP_WRITE_PER_POLL bytes of response, so it can run from the
+//  scheduler between frames. One client is served at a time from fixed
+//  buffers, the others wait in the WiFi module. Responses are JSON.
+//  Note WiFiNINA's stop() can wait for the module to close the socket.
+class HttpServer
+{
+public:
+    HttpServer(WiFiServer &server, HttpHandler handler) : m_server(server), m_handler(handler) {}
+
+    // Start listening, again after WiFi reconnects
+    void begin() { m_server.begin(); }
+
+    void poll();
+
+    uint32_t served() const { return m_served; }
+    uint32_t dropped() const { return m_dropped; } // Timed out, hung up or malformed
+
+private:
+    enum state_t
+    {
+        HTTP_IDLE,
+        HTTP_HEAD,  // Reading the request line and headers
+        HTTP_BODY,  // Reading Content-Length bytes
+        HTTP_WRITE  // Sending the response
+    };
+
+    void readHead();
+    void readBody();
+    void write();
+    bool headerLine();
+    void respond();
+    void close(bool served);
+
+    WiFiServer &m_server;
+    HttpHandler m_handler;
+    WiFiClient m_client;
+    state_t m_state = HTTP_IDLE;
+    uint32_t m_start_ms = 0;
+
+    HttpRequest m_request;
+    char m_line[HTTP_LINE_MAX];
+    uint8_t m_line_length = 0;
+    bool m_overflow = false;       // The line did not fit in m_line
+    bool m_first_line = true;
+    uint16_t m_status = 0;         // Set early when the request is refused
+    uint16_t m_content_length = 0;
+
+    char m_header[HTTP_HEADER_MAX];
+    char m_response[HTTP_RESPONSE_MAX];
+    uint16_t m_header_length = 0;
+    uint16_t m_response_length = 0;
+    uint16_t m_sent = 0; // Header and body bytes sent
+
+    uint32_t m_served = 0;
+    uint32_t m_dropped = 0;
+};
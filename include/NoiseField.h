@@ -0,0 +1,88 @@
+#pragma once
+
+#include <FastLED.h>
+
+#define NOISE_FIELD_SHIFT 8      // Lattice spacing is 1 << NOISE_FIELD_SHIFT inoise16 units
+#define NOISE_FIELD_MAX_ERROR 8  // Largest difference from inoise16, checked by the native bench
+
+// Cached 2D noise
+//  An N x N lattice of inoise16 values centred on the noise origin, read
+//  back with bilinear interpolation in fixed point. That is four table
+//  reads and three multiplies per sample against a full Perlin evaluation.
+//  The rainbow only rotates its sample points through a fixed field, so
+//  the lattice never goes stale. It is filled one row per refresh() so
+//  the cost is spread over the first frames, and samples fall back to
+//  inoise16 wherever it is not filled in yet.
+//  At 256 units spacing the field is close enough to planar that the
+//  interpolation error stays at the noise's own rounding.
+//  N is the most points per side. begin() uses only as many as the radius
+//  needs, so a smaller panel fills in sooner.
+// Lattice points per side covering |x|, |y| <= radius
+constexpr uint32_t noiseFieldSide(uint32_t radius)
+{
+    return (radius >> (NOISE_FIELD_SHIFT - 1)) + 2;
+}
+
+template <uint8_t N>
+class NoiseField
+{
+public:
+    // Start a new lattice covering |x|, |y| <= radius, false if N points do
+    // not reach that far (samples then always use inoise16)
+    bool begin(uint32_t radius)
+    {
+        m_rows = 0;
+        m_covers = noiseFieldSide(radius) <= N;
+        m_side = m_covers ? noiseFieldSide(radius) : 0;
+        m_half_span = ((int32_t)(m_side - 1) << NOISE_FIELD_SHIFT) / 2;
+        return m_covers;
+    }
+
+    // Sample the next lattice row, false once there is nothing left to do
+    bool refresh()
+    {
+        if (!m_covers || m_rows == m_side)
+        {
+            return false;
+        }
+        uint32_t y = (uint32_t)(((int32_t)m_rows << NOISE_FIELD_SHIFT) - m_half_span);
+        for (uint8_t i = 0; i < m_side; i++)
+        {
+            uint32_t x = (uint32_t)(((int32_t)i << NOISE_FIELD_SHIFT) - m_half_span);
+            m_values[m_rows][i] = inoise16(x, y);
+        }
+        m_rows++;
+        return true;
+    }
+
+    bool ready() const { return m_covers && m_rows == m_side; }
+
+    // Noise at (x, y), inoise16 coordinates as signed values
+    uint16_t sample(int32_t x, int32_t y) const
+    {
+        uint32_t u = x + m_half_span;
+        uint32_t v = y + m_half_span;
+        uint32_t i = u >> NOISE_FIELD_SHIFT;
+        uint32_t j = v >> NOISE_FIELD_SHIFT;
+        if (i + 1 >= m_side || j + 1 >= m_rows)
+        {
+            return inoise16((uint32_t)x, (uint32_t)y);
+        }
+
+        const uint16_t mask = (1 << NOISE_FIELD_SHIFT) - 1;
+        int32_t fx = u & mask;
+        int32_t fy = v & mask;
+        const uint16_t *row = m_values[j];
+        const uint16_t *next = m_values[j + 1];
+        int32_t top = row[i] + (((row[i + 1] - row[i]) * fx) >> NOISE_FIELD_SHIFT);
+        int32_t bottom = next[i] + (((next[i + 1] - next[i]) * fx) >> NOISE_FIELD_SHIFT);
+        return top + (((bottom - top) * fy) >> NOISE_FIELD_SHIFT);
+    }
+
+private:
+    uint16_t m_values[N][N];
+    uint8_t m_side = 0;     // Points per side in use
+    uint8_t m_rows = 0;     // Lattice rows filled in
+    bool m_covers = false;
+    int32_t m_half_span = 0;
+};
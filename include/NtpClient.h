@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <Udp.h>
+
+#define NTP_PACKET_SIZE 48
+#define NTP_LOCAL_PORT 2390
+#define NTP_TIMEOUT_MS 2000     // Time in milliseconds to wait for a reply
+#define NTP_BACKOFF_MIN_MS 4000 // Time in milliseconds before the first retry
+#define NTP_BACKOFF_MAX_MS 600000
+#define NTP_RESOLVE_MS 3600000  // Time in milliseconds between DNS lookups while queries fail
+
+enum ntp_state_t
+{
+    NTP_IDLE,
+    NTP_SEND,
+    NTP_WAITING,
+    NTP_BACKOFF
+};
+
+struct NtpResult
+{
+    uint32_t utc;         // Seconds since 1970 when the reply arrived
+    uint16_t utc_ms;      // Milliseconds past utc
+    uint32_t received_ms; // millis() when the reply arrived
+    uint32_t delay_ms;    // Round trip delay, less the server's processing time
+    uint8_t stratum;
+};
+
+// Look up a host name, returns nonzero on success. WiFi.hostByName() on the
+// device, it blocks until the module answers.
+typedef int (*NtpResolve)(const char *host, IPAddress &ip);
+
+// Non-blocking SNTP client
+//  request() queues a query and poll() advances it a step at a time: send,
+//  wait for the reply, then validate it and correct for half the round trip.
+//  A timeout or bad reply retries with exponential backoff until one succeeds.
+//
+//  The server's address is looked up once and kept, failures included, so
+//  an outage does not put a blocking DNS lookup in every retry. While
+//  queries keep failing it is looked up again every NTP_RESOLVE_MS, in
+//  case the name has moved.
+class NtpClient
+{
+public:
+    NtpClient(UDP &udp, NtpResolve resolve) : m_udp(udp), m_resolve(resolve) {}
+
+    // Set the server, looked up on the next query. server must stay valid.
+    void begin(const char *server, uint16_t port = 123);
+
+    // Start a query, ignored if one is already in progress
+    void request();
+
+    // Advance the query, returns true when a new result is ready
+    bool poll();
+
+    bool busy() const { return m_state != NTP_IDLE; }
+    ntp_state_t state() const { return m_state; }
+    const NtpResult &result() const { return m_result; }
+    uint32_t failures() const { return m_failures; }
+    uint32_t backoff() const { return m_backoff_ms; }
+    uint32_t lookups() const { return m_lookups; }
+    IPAddress serverIP() const { return m_server_ip; }
+
+private:
+    void send();
+    bool receive();
+    void fail();
+    bool resolve();
+
+    UDP &m_udp;
+    NtpResolve m_resolve;
+    const char *m_server = nullptr;
+    uint16_t m_port = 123;
+    IPAddress m_server_ip;      // Last address looked up, 0 for none
+    uint32_t m_resolved_ms = 0; // millis() of the last lookup
+    uint32_t m_lookups = 0;
+    bool m_retrying = false;    // The last query failed
+    bool m_started = false;
+
+    ntp_state_t m_state = NTP_IDLE;
+    uint32_t m_state_ms = 0; // millis() when the state was entered
+    uint32_t m_backoff_ms = NTP_BACKOFF_MIN_MS;
+    uint32_t m_failures = 0;
+    uint8_t m_nonce[8]; // Transmit timestamp sent, echoed back as the origin timestamp
+    NtpResult m_result = {};
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define NVM_FLASH_PAGE 64   // Smallest write on the SAMD21
+#define NVM_FLASH_ROW 256   // Smallest erase, 4 pages
+#define NVM_FLASH_SIZE 4096 // Bytes reserved at the top of program flash
+
+// Flash region for data that survives a reset
+//  Addresses are offsets into the region. Erased flash reads 0xFF and
+//  writing only clears bits, so a word is written once between erases.
+//  On the SAMD21 the region is the top NVM_FLASH_SIZE bytes of program
+//  flash, programmed through NVMCTRL. The CPU stalls while a row erases
+//  (a few ms) since code runs from the same flash. The native build keeps
+//  the region in RAM (see NativeHal.h).
+class NvmFlash
+{
+public:
+    // False if the region is not usable, e.g. the program reaches into it
+    bool begin();
+
+    uint32_t size() const { return NVM_FLASH_SIZE; }
+
+    void read(uint32_t addr, void *buf, uint32_t len);
+
+    // Erase the row holding addr
+    bool erase(uint32_t addr);
+
+    // Program len bytes, addr and len are multiples of 4
+    bool write(uint32_t addr, const void *data, uint32_t len);
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <stdint.h>
+
+// LED panel wiring
+//  A matrix is tiles_x by tiles_y panels, each panel_width by panel_height
+//  LEDs, chained from the bottom left panel. Grid coordinates are (x, y)
+//  from the top left of the whole matrix, like the face letters.
+//
+//  An unrotated panel starts at its bottom left LED and runs along rows
+//  to the right, from the bottom row up. Serpentine panels reverse every
+//  other row, progressive panels start each row at the left again.
+//  Rotation is how far the panel is turned clockwise from that, so it
+//  moves where the strip starts. Turned 90 or 270 the panel's own rows run
+//  down the grid.
+enum panel_wiring_t
+{
+    PANEL_PROGRESSIVE,
+    PANEL_SERPENTINE
+};
+
+enum panel_rotation_t
+{
+    PANEL_ROTATE_0,
+    PANEL_ROTATE_90,
+    PANEL_ROTATE_180,
+    PANEL_ROTATE_270
+};
+
+struct PanelLayout
+{
+    uint16_t panel_width; // LEDs across one panel as mounted
+    uint16_t panel_height;
+    uint8_t tiles_x;
+    uint8_t tiles_y;
+    panel_wiring_t wiring;
+    panel_rotation_t rotation;
+    bool tile_serpentine; // Panel chain reverses every other row of panels
+};
+
+// Strip index of grid (x, y)
+constexpr uint16_t panelIndex(const PanelLayout &layout, uint16_t x, uint16_t y)
+{
+    uint16_t pw = layout.panel_width;
+    uint16_t ph = layout.panel_height;
+
+    // Which panel, counted along the chain
+    uint16_t tile_row = layout.tiles_y - 1 - y / ph;
+    uint16_t tile_col = x / pw;
+    if (layout.tile_serpentine && tile_row % 2)
+    {
+        tile_col = layout.tiles_x - 1 - tile_col;
+    }
+    uint32_t tile = (uint32_t)tile_row * layout.tiles_x + tile_col;
+
+    // Undo the rotation to get the panel's own coordinates
+    uint16_t lx = x % pw;
+    uint16_t ly = y % ph;
+    uint16_t nx = lx, ny = ly, nw = pw, nh = ph;
+    switch (layout.rotation)
+    {
+    case PANEL_ROTATE_90:
+        nx = ly;
+        ny = pw - 1 - lx;
+        nw = ph;
+        nh = pw;
+        break;
+    case PANEL_ROTATE_180:
+        nx = pw - 1 - lx;
+        ny = ph - 1 - ly;
+        break;
+    case PANEL_ROTATE_270:
+        nx = ph - 1 - ly;
+        ny = lx;
+        nw = ph;
+        nh = pw;
+        break;
+    default:
+        break;
+    }
+
+    uint16_t row = nh - 1 - ny;
+    uint16_t col = layout.wiring == PANEL_SERPENTINE && row % 2 ? nw - 1 - nx : nx;
+    return tile * pw * ph + (uint32_t)row * nw + col;
+}
+
+// Grid position of a strip LED
+struct PanelPoint
+{
+    uint8_t x;
+    uint8_t y;
+};
+
+// Runtime view of a PanelMapTable, for kernels that work on any size
+struct PanelView
+{
+    uint16_t width;
+    uint16_t height;
+    uint16_t leds;
+    const uint16_t *index;    // [y * width + x] -> strip index
+    const PanelPoint *point;  // [strip index] -> (x, y)
+};
+
+// Strip index for every grid cell and the inverse, generated at compile time
+//  Kernels that walk point[] in strip order write leds[] sequentially,
+//  the order the data goes out in.
+template <uint16_t W, uint16_t H>
+struct PanelMapTable
+{
+    static_assert(W <= 256 && H <= 256, "PanelPoint holds 8-bit coordinates");
+    static_assert((uint32_t)W * H <= 65535, "Strip indices are 16-bit");
+
+    uint16_t index[H][W] = {};
+    PanelPoint point[W * H] = {};
+
+    constexpr PanelMapTable(const PanelLayout &layout)
+    {
+        for (uint16_t y = 0; y < H; y++)
+        {
+            for (uint16_t x = 0; x < W; x++)
+            {
+                uint16_t led = panelIndex(layout, x, y);
+                index[y][x] = led;
+                point[led] = {(uint8_t)x, (uint8_t)y};
+            }
+        }
+    }
+
+    // Every strip LED is on exactly one grid cell
+    constexpr bool complete() const
+    {
+        for (uint16_t led = 0; led < W * H; led++)
+        {
+            if (index[point[led].y][point[led].x] != led)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr const uint16_t *operator[](uint16_t row) const
+    {
+        return index[row];
+    }
+
+    PanelView view() const
+    {
+        return {W, H, W * H, &index[0][0], point};
+    }
+};
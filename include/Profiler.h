@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Per-stage timing
+//  PROFILE_STAGE(stage) at the top of a block times the rest of the block.
+//  It compiles to nothing unless WORDCLOCK_PROFILE is defined before this
+//  header is included. When on it costs two micros() reads per block.
+
+#define PROFILE_BUCKETS 16 // log2 buckets of microseconds, the last one is open ended
+
+enum profile_stage_t
+{
+    PROFILE_SENSOR,     // Brightness ADC read
+    PROFILE_BACKGROUND, // Background kernel
+    PROFILE_WORDCLOCK,  // updateWC()
+    PROFILE_SHOW,       // FastLED.show()
+    PROFILE_PRINT,      // Serial time printout
+    PROFILE_WIFI,       // WiFi check and reconnect
+    PROFILE_SYNC,       // NTP client and RTC discipline
+    PROFILE_STAGES
+};
+
+struct ProfileStats
+{
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[PROFILE_BUCKETS]; // Bucket b holds times in [2^(b-1), 2^b) us, bucket 0 is 0 us
+};
+
+void profileRecord(profile_stage_t stage, uint32_t elapsed_us);
+void profileReset();
+const ProfileStats &profileStats(profile_stage_t stage);
+
+// Table of count, min/mean/max and the nonzero buckets of every stage
+void profileDump(Print &out);
+
+class ProfileScope
+{
+public:
+    ProfileScope(profile_stage_t stage) : m_stage(stage), m_start(micros()) {}
+    ~ProfileScope() { profileRecord(m_stage, micros() - m_start); }
+
+private:
+    profile_stage_t m_stage;
+    uint32_t m_start;
+};
+
+#ifdef WORDCLOCK_PROFILE
+#define PROFILE_STAGE(stage) ProfileScope profile_scope(stage)
+#else
+#define PROFILE_STAGE(stage)
+#endif
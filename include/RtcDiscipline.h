@@ -0,0 +1,101 @@
+#pragma once
+
+#include <RTCZero.h>
+
+#include "DriftEstimator.h"
+#include "NtpClient.h"
+
+#define RTC_FREQCORR_PPB 954 // FREQCORR step, 1/2^20
+#define RTC_FREQCORR_MAX 127
+#define RTC_FREQCORR_NEGATIVE 0x80 // SIGN bit, set to speed the RTC up
+
+enum rtc_sync_t
+{
+    RTC_SYNC_IDLE,
+    RTC_SYNC_EDGE,  // Waiting for an RTC second edge before querying
+    RTC_SYNC_QUERY, // Edge seen, NTP query can go out
+    RTC_SYNC_PHASE  // RTC set, waiting for its next edge to measure the phase
+};
+
+// What is kept over a reset
+struct RtcState
+{
+    uint32_t utc;      // Corrected time when it was taken
+    int32_t drift_ppb; // Drift estimate
+};
+
+// Read the RTC clock register once as a UTC epoch
+uint32_t readRtcEpoch(RTCZero &rtc);
+
+// FREQCORR register value for a drift in ppb, positive when the RTC runs
+// fast, clamped to RTC_FREQCORR_MAX steps
+uint8_t rtcFreqCorr(int32_t ppb);
+
+// Correction in ppb a FREQCORR value applies
+int32_t rtcFreqCorrPpb(uint8_t freqcorr);
+
+// Keeps the RTC on time between syncs
+//  The RTC only counts whole seconds, so offsets are timed from the millis()
+//  at which its seconds roll over, both when an NTP reply arrives and just
+//  after the RTC is set. The drift estimate is split between the RTC's
+//  FREQCORR register (up to about 121 ppm) and a software correction, and
+//  the phase left by setting the RTC mid-second is corrected in software.
+class RtcDiscipline
+{
+public:
+    RtcDiscipline(RTCZero &rtc) : m_rtc(rtc) {}
+
+    // Milliseconds to add to an RTC reading
+    int32_t correctionMs(uint32_t rtc_utc) const;
+
+    // Corrected UTC epoch for an RTC reading
+    uint32_t correct(uint32_t rtc_utc) const;
+
+    // Corrected UTC epoch now
+    uint32_t now() { return correct(readRtcEpoch(m_rtc)); }
+
+    // Sync steps, driven from the NTP task
+    void startSync();
+    void poll();
+    bool readyToQuery() const { return m_state == RTC_SYNC_QUERY; }
+    void setTime(const NtpResult &result);
+
+    // Time and drift worth keeping, once synced
+    RtcState state() { return {now(), m_drift.ppb()}; }
+
+    // Start from a kept state before the first sync. The RTC is moved on
+    // to its time if it is behind (it starts at 2000-01-01 on power up),
+    // and the drift correction applies at once, the software share counted
+    // from here. The kept time is as old as the last save plus the time
+    // off, so it stays unverified: synced() is false until an NTP reply.
+    // Returns true if the RTC was set.
+    bool restore(const RtcState &state);
+
+    bool syncing() const { return m_state != RTC_SYNC_IDLE; }
+    bool synced() const { return m_synced; }
+    int32_t lastOffsetMs() const { return m_offset_ms; }
+    uint32_t syncIntervalMs() const { return m_drift.syncInterval() * 1000; }
+    const DriftEstimator &drift() const { return m_drift; }
+
+private:
+    void apply(int32_t ppb);
+
+    RTCZero &m_rtc;
+    DriftEstimator m_drift;
+    rtc_sync_t m_state = RTC_SYNC_IDLE;
+
+    uint32_t m_edge_epoch = 0; // RTC reading after the last second edge
+    uint32_t m_edge_ms = 0;    // millis() when the edge was seen
+
+    NtpResult m_result = {}; // Reply the RTC was set from
+    int32_t m_offset_ms = 0; // True minus corrected RTC time at the last reply
+    bool m_measured = false; // m_offset_ms is valid for the drift estimate
+    uint32_t m_interval_s = 0; // Seconds from the previous anchor to the last reply
+
+    bool m_synced = false;
+    bool m_restored = false;   // Corrections run from restore() until the first sync
+    uint32_t m_anchor_utc = 0; // RTC reading the corrections count from
+    int32_t m_phase_ms = 0;    // True minus RTC time at the anchor
+    int32_t m_hw_ppb = 0;      // Correction applied by FREQCORR
+    int32_t m_sw_ppb = 0;      // Correction applied by correctionMs()
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define SCHEDULER_MAX_TASKS 12
+
+typedef void (*TaskFunction)();
+
+struct Task
+{
+    const char *name;
+    TaskFunction run;
+    uint32_t period_ms; // Time in milliseconds between runs
+    uint8_t priority;   // Higher runs first when several tasks are due
+    uint32_t next_ms;   // Time in milliseconds of the next deadline
+    uint32_t max_us;    // Longest run in microseconds
+    uint32_t runs;
+    uint32_t overruns; // Runs started a full period or more past their deadline
+};
+
+// Cooperative deadline scheduler
+//  All times are compared by unsigned difference, so millis() wrapping is safe.
+//  One task can be guarded: other tasks only start when their longest run fits
+//  before the guarded task's next deadline, or when more than half of its
+//  period is left (so long tasks still run, but right after the guarded one).
+//  A task held back this way does not hold back the due tasks behind it.
+class Scheduler
+{
+public:
+    // Add a task, returns its id or -1 when the table is full
+    int8_t add(const char *name, TaskFunction run, uint32_t period_ms, uint8_t priority);
+
+    // Reserve the time before this task's deadlines
+    void guard(int8_t id) { m_guard = id; }
+
+    // Run the most urgent due task, returns false if nothing ran
+    bool runOnce();
+
+    // Make a task due immediately
+    void runNow(int8_t id) { m_tasks[id].next_ms = millis(); }
+
+    void setPeriod(int8_t id, uint32_t period_ms) { m_tasks[id].period_ms = period_ms; }
+
+    uint8_t count() const { return m_count; }
+    const Task &task(uint8_t id) const { return m_tasks[id]; }
+
+private:
+    bool fits(uint8_t id, uint32_t now) const;
+
+    Task m_tasks[SCHEDULER_MAX_TASKS];
+    uint8_t m_count = 0;
+    int8_t m_guard = -1;
+};
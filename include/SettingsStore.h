@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "NvmFlash.h"
+
+#define SETTINGS_SECTORS 4     // The flash region is split into this many sectors
+#define SETTINGS_KEYS 16       // Keys are 0 to SETTINGS_KEYS - 1
+#define SETTINGS_VALUE_MAX 48  // Longest value in bytes
+
+const uint32_t SETTINGS_SECTOR_SIZE = NVM_FLASH_SIZE / SETTINGS_SECTORS;
+
+static_assert(SETTINGS_SECTOR_SIZE % NVM_FLASH_ROW == 0, "Sectors are whole rows");
+static_assert(SETTINGS_SECTOR_SIZE <= 65535, "Record offsets are 16-bit");
+static_assert(12 + SETTINGS_KEYS * (4 + SETTINGS_VALUE_MAX) <= SETTINGS_SECTOR_SIZE,
+              "Every key at its longest must fit in a compacted sector");
+
+// Console parameter kept in the store, a key is never reused for anything else
+struct StoredParameter
+{
+    uint8_t key;
+    const char *name;
+};
+
+// Key/value log in flash
+//  The active sector starts with a header (magic, generation) followed by
+//  records appended in order: key, length, CRC-16, then the value padded
+//  to 4 bytes. The newest record of a key wins. Erased flash ends the log.
+//
+//  When a sector is full the live records are copied to the next sector in
+//  turn, whose header is written last with the next generation, so a reset
+//  at any point leaves either the old or the new sector complete. Going
+//  round the sectors spreads erases evenly over the region. A record cut
+//  short by a reset fails its CRC and the key keeps its previous value.
+//
+//  begin() reads the sector headers, then the active sector once from the
+//  start and keeps where each key's newest record is.
+class SettingsStore
+{
+public:
+    SettingsStore(NvmFlash &flash) : m_flash(flash) {}
+
+    // Find the newest sector and index it, formats an empty or unreadable
+    // region. False if the flash cannot be used.
+    bool begin();
+
+    bool ready() const { return m_ready; }
+
+    // Copy the value of key into buf, returns its length, 0 if it has none
+    // or it does not fit
+    uint8_t read(uint8_t key, void *buf, uint8_t size);
+
+    // Append a value unless it is already the stored one, compacting into
+    // the next sector first when this one is full
+    bool write(uint8_t key, const void *data, uint8_t len);
+
+    uint32_t generation() const { return m_generation; }
+    uint16_t used() const { return m_end; } // Bytes of the active sector in use
+    uint32_t appends() const { return m_appends; }
+    uint32_t compactions() const { return m_compactions; }
+
+    void dump(Print &out);
+
+private:
+    bool format();
+    bool compact(uint8_t key, const void *data, uint8_t len);
+    bool append(uint32_t sector, uint16_t &end, uint8_t key, const void *data, uint8_t len);
+    uint32_t sectorAddress(uint8_t sector) const { return sector * SETTINGS_SECTOR_SIZE; }
+
+    NvmFlash &m_flash;
+    bool m_ready = false;
+    uint8_t m_sector = 0;                  // Active sector
+    uint32_t m_generation = 0;             // Its generation, the newest sector has the highest
+    uint16_t m_end = 0;                    // Offset of the next record in the active sector
+    uint16_t m_offset[SETTINGS_KEYS] = {}; // Newest record of each key, 0 for none
+    uint32_t m_appends = 0;
+    uint32_t m_compactions = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "TelemetryFormat.h"
+
+#define TELEMETRY_BUFFER_SIZE 1024 // Power of two
+
+// Binary telemetry stream
+//  Records are framed into a ring buffer and drained to the output only as
+//  fast as it takes them, so a slow or absent USB host never stalls the loop.
+//  A record that does not fit is dropped whole and counted.
+//  The ring is lock-free for one producer and one consumer. drain() may run
+//  from an interrupt, such as a transmit interrupt, but every send() has
+//  to come from the loop: it is not guarded against interrupts, and a
+//  record sent from one could interleave with one the loop is writing.
+//  Printing to it sends text records, one per line or per TELEMETRY_MAX_PAYLOAD
+//  characters.
+class Telemetry : public Print
+{
+public:
+    Telemetry(Print &out) : m_out(out) {}
+
+    // Frame and queue a record, returns false if it was dropped
+    bool send(telemetry_type_t type, const void *payload, uint8_t length);
+
+    // Write as much as the output can take without blocking
+    void drain();
+
+    // Text
+    size_t write(uint8_t c) override;
+    using Print::write;
+    void flush() override;
+
+    uint32_t dropped() const { return m_dropped; }
+    uint32_t sent() const { return m_sent; }
+
+private:
+    Print &m_out;
+
+    uint8_t m_buffer[TELEMETRY_BUFFER_SIZE];
+    uint16_t m_head = 0; // Next byte to write, only the producer moves it
+    uint16_t m_tail = 0; // Next byte to drain, only the consumer moves it
+    uint32_t m_dropped = 0;
+    uint32_t m_sent = 0;
+
+    char m_line[TELEMETRY_MAX_PAYLOAD];
+    uint8_t m_line_length = 0;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stdint.h>
+
+// Telemetry wire format, shared by the firmware and tools/telemetry_decode.cpp
+//
+// Every record is framed as
+//  magic (0xA5), version, type, payload length, millis() (4 bytes),
+//  payload, CRC-8 over everything after the magic byte
+// Multi-byte fields are little endian. Bytes outside a valid frame are
+// plain text and decoders pass them through.
+//
+// The framing never changes. TELEMETRY_VERSION goes up with every change to
+// the record types: a type added, or a payload changed, which also needs a
+// new type. Decoders read frames of any version and flag the ones newer
+// than they know, so an old decoder says it is out of date rather than
+// just counting unknown records. telemetryVersionTypes below keeps the
+// history, and a type added without a bump does not compile.
+
+#define TELEMETRY_MAGIC 0xA5
+#define TELEMETRY_VERSION 4
+#define TELEMETRY_HEADER_SIZE 8
+#define TELEMETRY_MAX_PAYLOAD 64
+#define TELEMETRY_MAX_RECORD (TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_PAYLOAD + 1)
+
+enum telemetry_type_t
+{
+    TELEMETRY_TEXT = 1,    // Log text, not null terminated, lines may span records
+    TELEMETRY_TIME,        // TelemetryTime
+    TELEMETRY_CLOCK_SYNC,  // TelemetryClockSync
+    TELEMETRY_BRIGHTNESS,  // TelemetryBrightness
+    TELEMETRY_FRAME_STATS, // TelemetryFrameStats
+    TELEMETRY_GOVERNOR,    // TelemetryGovernor
+    TELEMETRY_BOOT_V3,     // TelemetryBootV3, version 3 only
+    TELEMETRY_BOOT,        // TelemetryBoot
+    TELEMETRY_TYPE_END     // One past the newest type
+};
+
+// Newest record type at each version, [version - 1]
+//  1  TEXT, TIME, CLOCK_SYNC, BRIGHTNESS, FRAME_STATS
+//  2  GOVERNOR
+//  3  BOOT_V3
+//  4  BOOT, BOOT_V3 with how stale a restored time may be
+constexpr uint8_t telemetryVersionTypes[TELEMETRY_VERSION] = {TELEMETRY_FRAME_STATS, TELEMETRY_GOVERNOR,
+                                                              TELEMETRY_BOOT_V3, TELEMETRY_BOOT};
+static_assert(telemetryVersionTypes[TELEMETRY_VERSION - 1] == TELEMETRY_TYPE_END - 1,
+              "Record types changed, bump TELEMETRY_VERSION and extend telemetryVersionTypes");
+
+struct __attribute__((packed)) TelemetryTime
+{
+    uint32_t utc;
+    uint32_t local; // utc with the timezone offset applied
+    uint8_t dst;
+};
+
+struct __attribute__((packed)) TelemetryClockSync
+{
+    uint32_t utc;       // Server time of the reply
+    uint16_t delay_ms;  // Round trip
+    int32_t offset_ms;  // Server minus corrected RTC time, positive when the RTC was behind
+    int32_t drift_ppb;  // Estimated RTC drift
+    uint32_t next_s;    // Time until the next sync
+    uint8_t stratum;
+};
+
+struct __attribute__((packed)) TelemetryBrightness
+{
+    uint16_t adc; // Raw sensor reading
+    uint8_t brightness;
+};
+
+struct __attribute__((packed)) TelemetryFrameStats
+{
+    uint32_t frames;         // Rendered frames since boot
+    uint32_t refreshes;      // Dithered refreshes since boot
+    uint32_t render_max_us;  // Longest render
+    uint32_t refresh_max_us; // Longest refresh
+    uint32_t overruns;       // Render deadlines missed by a full period
+    uint32_t dropped;        // Telemetry records dropped on a full buffer
+};
+
+struct __attribute__((packed)) TelemetryGovernor
+{
+    uint8_t level;       // Quality level, 0 is full
+    uint16_t period_ms;  // Frame period
+    uint16_t refresh_ms; // Dithered refresh period
+    uint32_t frame_us;   // Mean render and show time
+    uint32_t refresh_us; // Mean refresh time
+    uint32_t missed;     // Frames that came later than the deadline
+};
+
+struct __attribute__((packed)) TelemetryBootV3
+{
+    uint8_t restored;
+    uint32_t first_frame_ms;
+    uint32_t connected_ms;
+    uint32_t verified_ms;
+    int32_t error_s;
+};
+
+struct __attribute__((packed)) TelemetryBoot
+{
+    uint8_t restored;        // Clock started from the saved time
+    uint32_t stale_max_s;    // The saved time is behind by up to this plus the time powered off
+    uint32_t first_frame_ms; // Boot to the first frame
+    uint32_t connected_ms;   // Boot to WiFi connected
+    uint32_t verified_ms;    // Boot to the first frame after the first sync
+    int32_t error_s;         // Time shown minus NTP time at the first sync
+};
+
+static_assert(sizeof(TelemetryClockSync) <= TELEMETRY_MAX_PAYLOAD, "Record too large");
+static_assert(sizeof(TelemetryFrameStats) <= TELEMETRY_MAX_PAYLOAD, "Record too large");
+
+// CRC-8, polynomial 0x07
+static inline uint8_t telemetryCrc(uint8_t crc, const uint8_t *data, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <FastLED.h>
+
+// Sigma-delta temporal dithering of the brightness scaling
+//  A rendered frame is latched with the current brightness. Each channel's
+//  level is its 8-bit value times the brightness, a 16 bit product. Each
+//  refresh outputs the top 8 bits of level plus carry and keeps the low 8
+//  bits as the next carry, so a channel averages out to the exact scaled
+//  value over a few refreshes instead of rounding down to the step below.
+//  That keeps dim backgrounds from collapsing to a few levels at low
+//  brightness. Precision the frame lost before the latch, in the effects'
+//  own 8-bit scaling, is not recovered. The level is worked out on each
+//  refresh from the 8-bit frame and one scale, which keeps the state to 2
+//  bytes per channel.
+template <uint16_t N>
+class TemporalDither
+{
+public:
+    // Keep a rendered frame and the brightness to scale it by
+    void latch(const CRGB *frame, uint8_t brightness)
+    {
+        memcpy(m_frame, frame, sizeof(m_frame));
+        m_scale = brightness ? brightness + 1 : 0;
+    }
+
+    // Write one dithered refresh of the framebuffer
+    void refresh(CRGB *out)
+    {
+        uint8_t *dst = (uint8_t *)out;
+        for (uint16_t i = 0; i < N * 3; i++)
+        {
+            uint16_t acc = m_frame[i] * m_scale + m_error[i];
+            dst[i] = acc >> 8;
+            m_error[i] = acc & 0xFF;
+        }
+    }
+
+private:
+    uint8_t m_frame[N * 3] = {};
+    uint8_t m_error[N * 3] = {};
+    uint16_t m_scale = 0;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "RtcDiscipline.h"
+#include "TimeZone.h"
+
+// Time read once from the RTC, every field decoded from the same read
+struct TimeSnapshot
+{
+    uint32_t utc;   // Seconds since 1970 in UTC, drift corrected
+    uint32_t local; // utc with the timezone offset applied
+    bool dst;
+    DateTime time; // Local calendar fields
+};
+
+// Read the RTC clock register once and fill in the snapshot
+void readTimeSnapshot(RtcDiscipline &clock, TimeZone &tz, TimeSnapshot &snapshot);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+
+#define SECONDS_PER_DAY 86400
+
+// Calendar date and time, epochs are seconds since 1970-01-01 00:00:00
+struct DateTime
+{
+    uint16_t year;
+    uint8_t month;   // 1-12
+    uint8_t day;     // 1-31
+    uint8_t hour;    // 0-23
+    uint8_t minute;  // 0-59
+    uint8_t second;  // 0-59
+    uint8_t weekday; // 0 = Sunday
+};
+
+// Days since 1970-01-01 for a date from 1970 on
+uint32_t daysFromCivil(uint16_t year, uint8_t month, uint8_t day);
+
+// Split an epoch into calendar fields
+void breakTime(uint32_t epoch, DateTime &time);
+
+// Epoch of calendar fields, weekday is ignored
+uint32_t makeTime(const DateTime &time);
+
+// Timezone from a POSIX TZ rule
+//  e.g. "EST5EDT,M3.2.0,M11.1.0" for US Eastern or "CET-1CEST,M3.5.0,M10.5.0/3".
+//  The DST start and end for the current year are worked out once and cached,
+//  after that a lookup is a range check and an add until the year rolls over.
+//  Only the Mm.w.d form of transition dates is supported.
+class TimeZone
+{
+public:
+    // Parse a rule, returns false and falls back to UTC if it is not understood
+    bool begin(const char *rule);
+
+    // True if DST is in effect at a UTC epoch
+    bool isDST(uint32_t utc)
+    {
+        if (utc < m_year_start || utc >= m_year_end)
+        {
+            updateYear(utc);
+        }
+        if (!m_has_dst)
+        {
+            return false;
+        }
+        if (m_dst_start < m_dst_end)
+        {
+            return utc >= m_dst_start && utc < m_dst_end;
+        }
+        // Southern hemisphere, DST spans the new year
+        return utc >= m_dst_start || utc < m_dst_end;
+    }
+
+    // Seconds east of UTC in effect at a UTC epoch
+    int32_t offset(uint32_t utc) { return isDST(utc) ? m_dst_offset : m_std_offset; }
+
+    uint32_t toLocal(uint32_t utc) { return utc + offset(utc); }
+
+private:
+    struct Transition
+    {
+        uint8_t month;   // 1-12
+        uint8_t week;    // 1-5, 5 is the last week of the month
+        uint8_t weekday; // 0 = Sunday
+        int32_t time;    // Seconds after local midnight
+    };
+
+    void updateYear(uint32_t utc);
+    uint32_t transitionLocal(uint16_t year, const Transition &transition) const;
+
+    int32_t m_std_offset = 0;
+    int32_t m_dst_offset = 0;
+    bool m_has_dst = false;
+    Transition m_start = {};
+    Transition m_end = {};
+    uint32_t m_year_start = 1; // UTC range of the cached year, empty until first use
+    uint32_t m_year_end = 0;
+    uint32_t m_dst_start = 0; // UTC epochs of this year's transitions
+    uint32_t m_dst_end = 0;
+};
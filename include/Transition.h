@@ -0,0 +1,58 @@
+#pragma once
+
+#include <FastLED.h>
+
+#include "WordMask.h"
+
+#define TRANSITION_EASE_STEPS 64 // Steps in the easing table
+
+enum transition_style_t
+{
+    TRANSITION_CUT,        // Switch in one frame
+    TRANSITION_CROSSFADE,  // Old words fade out while new ones fade in
+    TRANSITION_WIPE,       // Letters change column by column, left to right
+    TRANSITION_TYPEWRITER, // Old words fade out, then new letters light in reading order
+    TRANSITION_STYLES
+};
+
+// Phrase change animation
+//  start() works out when each changing LED begins to fade and how long it
+//  takes, so composite() is one table lookup and blend per lit LED. Every
+//  style finishes within the configured number of frames.
+class Transition
+{
+public:
+    void configure(transition_style_t style, uint8_t frames);
+
+    // Plan the change between two phrases, meant as a WordLayer listener
+    void start(const LedMask &from, const LedMask &to);
+
+    bool active() const { return m_frame < m_frames; }
+
+    // Blend the words over the background for this frame, then step on
+    void composite(CRGB *leds);
+
+private:
+    enum fade_t : uint8_t
+    {
+        FADE_IN,
+        FADE_OUT,
+        FADE_STEADY
+    };
+    struct Fade
+    {
+        uint8_t led;
+        uint8_t start; // Frame the fade begins
+        fade_t kind;
+    };
+
+    transition_style_t m_style = TRANSITION_CROSSFADE;
+    uint8_t m_frames_config = 10;
+
+    Fade m_fades[WC_LEDS];
+    uint8_t m_count = 0;
+    uint8_t m_ramp = 1;       // Frames for one LED to fade
+    uint16_t m_ease_step = 0; // Easing table steps per frame of a fade, Q8
+    uint8_t m_frame = 0;
+    uint8_t m_frames = 0; // Length of the running transition
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+// WS2812 waveform as SPI data at 2.4 MHz
+//  Each data bit is sent as 3 SPI bits, 0 -> 100 and 1 -> 110, giving a
+//  1.25 us bit with 417 ns or 833 ns high time. Each colour byte becomes
+//  3 SPI bytes, so a pixel is 9 bytes.
+#define WS2812_SPI_HZ 2400000
+#define WS2812_BYTES_PER_PIXEL 9
+#define WS2812_RESET_BYTES 90 // Low time after a frame, > 280 us at 2.4 MHz
+#define WS2812_BUFFER_SIZE(N) ((N) * WS2812_BYTES_PER_PIXEL + WS2812_RESET_BYTES)
+
+// Encode count RGB pixels into out as GRB waveform bytes
+//  Each channel is scaled like FastLED's scale8, (value * (scale + 1)) >> 8.
+//  Writes count * WS2812_BYTES_PER_PIXEL bytes, the reset is left to the caller.
+void ws2812Encode(const uint8_t *rgb, uint16_t count, const uint8_t scale[3], uint8_t *out);
+
+// Hold the line low after count encoded pixels in out so the strip
+// latches, returns the length of the whole frame
+uint16_t ws2812Reset(uint8_t *out, uint16_t count);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <FastLED.h>
+
+#include "WordMask.h"
+
+#define WORD_LAYER_LISTENERS 4
+
+// Called with the previous and new phrase when the lit words change
+typedef void (*WordLayerChanged)(const LedMask &from, const LedMask &to);
+
+// Foreground words, rebuilt only when the (hour, slot) key changes
+class WordLayer
+{
+public:
+    // Rebuild the cached words for this local hour (DST applied) and
+    // 5 minute slot, returns true if they changed
+    bool update(uint8_t hour, uint8_t slot);
+
+    // Draw the cached words over the background
+    void composite(CRGB *leds) const;
+
+    // Scale the colour of the lit words by tint, channel by channel
+    void tint(CRGB *leds, const CRGB &tint) const;
+
+    // Register for phrase changes, returns false if all slots are taken
+    bool onChanged(WordLayerChanged listener);
+
+    const LedMask &mask() const { return m_mask; }
+
+private:
+    uint16_t m_key = 0xFFFF;
+    LedMask m_mask;
+    uint8_t m_leds[WC_LEDS]; // Lit LED indices from m_mask
+    uint16_t m_count = 0;
+    WordLayerChanged m_listeners[WORD_LAYER_LISTENERS] = {};
+};
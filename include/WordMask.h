@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stdint.h>
+
+// Word Clock
+//  The face (letters, words and phrase grammar) is data in include/faces/,
+//  picked at build time with -DWORDCLOCK_FACE=<namespace>. Everything below
+//  is derived from it at compile time and stored in flash.
+//
+//  LEDs, serpentine from the bottom left (12 x 10 shown):
+//  119 118 ... 109 108
+//  96  97  ... 106 107
+//  95  94  ... 85  84
+//  ...
+//  23  22  ... 13  12
+//  0   1   ... 10  11
+//
+//  Index:
+//  [0,0] -> [WC_X-1,0]
+//  ...
+//  [0,WC_Y-1] -> [WC_X-1,WC_Y-1]
+#include "PanelMap.h"
+#include "faces/Faces.h"
+
+#ifndef WORDCLOCK_FACE
+#define WORDCLOCK_FACE FaceEnglish
+#endif
+namespace Face = WORDCLOCK_FACE;
+
+#define WC_X Face::WIDTH
+#define WC_Y Face::HEIGHT
+#define WC_LEDS (WC_X * WC_Y)
+
+static_assert(WC_LEDS <= 256, "WordLayer and Transition store LED indices as uint8_t");
+
+// One panel the size of the face, wired as drawn above
+constexpr PanelLayout wcPanel = {WC_X, WC_Y, 1, 1, PANEL_SERPENTINE, PANEL_ROTATE_0, false};
+
+// LED index for each [row][col], and the inverse
+constexpr PanelMapTable<WC_X, WC_Y> ledMap(wcPanel);
+static_assert(ledMap.complete(), "wcPanel does not cover the face");
+
+// One bit per LED, bit n is leds[n]
+#define LED_MASK_WORDS ((WC_LEDS + 31) / 32)
+struct LedMask
+{
+    uint32_t bits[LED_MASK_WORDS] = {};
+
+    constexpr void set(uint16_t led)
+    {
+        bits[led / 32] |= (uint32_t)1 << (led % 32);
+    }
+
+    constexpr bool test(uint16_t led) const
+    {
+        return bits[led / 32] & ((uint32_t)1 << (led % 32));
+    }
+
+    constexpr LedMask &operator|=(const LedMask &other)
+    {
+        for (uint8_t i = 0; i < LED_MASK_WORDS; i++)
+        {
+            bits[i] |= other.bits[i];
+        }
+        return *this;
+    }
+
+    constexpr bool operator==(const LedMask &other) const
+    {
+        for (uint8_t i = 0; i < LED_MASK_WORDS; i++)
+        {
+            if (bits[i] != other.bits[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool operator!=(const LedMask &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+constexpr LedMask wordMaskOf(uint8_t word)
+{
+    LedMask mask;
+    const FaceWord &span = Face::words[word];
+    for (uint8_t i = 0; span.text[i]; i++)
+    {
+        mask.set(ledMap[span.row][span.col + i]);
+    }
+    return mask;
+}
+
+struct WordMaskTable
+{
+    LedMask word[Face::WORDS];
+
+    constexpr WordMaskTable()
+    {
+        for (uint8_t w = 0; w < Face::WORDS; w++)
+        {
+            word[w] = wordMaskOf(w);
+        }
+    }
+};
+
+// Full phrase for every hour % 12 and 5 minute slot
+struct PhraseMaskTable
+{
+    LedMask phrase[12][12];
+
+    constexpr PhraseMaskTable()
+    {
+        for (uint8_t hour = 0; hour < 12; hour++)
+        {
+            for (uint8_t slot = 0; slot < 12; slot++)
+            {
+                const FaceSlot &grammar = Face::slots[slot];
+                uint32_t words = Face::ALWAYS | grammar.words |
+                                 FACE_WORD(grammar.hours[(hour + grammar.hour_offset) % 12]);
+                LedMask &mask = phrase[hour][slot];
+                for (uint8_t w = 0; w < Face::WORDS; w++)
+                {
+                    if (words & FACE_WORD(w))
+                    {
+                        mask |= wordMaskOf(w);
+                    }
+                }
+            }
+        }
+    }
+};
+
+extern const WordMaskTable wordMask;
+extern const PhraseMaskTable phraseMask;
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Face.h"
+
+// English, 12 x 10
+//  I T T I S I M H A L F E
+//  A Q U A R T E R N T E N
+//  T W E N T Y D F I V E D
+//  P A S T A T O T E O N E
+//  T W E L V E T I M T W O
+//  A T H R E E E N F O U R
+//  F I V E S I X D N I N E
+//  S E V E N D A E I G H T
+//  T E N T E L E V E N E T
+//  I M O ' C L O C K E A N
+//
+//  IT IS [HALF,QUARTER,TEN,TWENTY,FIVE] [PAST,TO] [ONE..TWELVE] O'CLOCK
+namespace FaceEnglish
+{
+constexpr uint8_t WIDTH = 12;
+constexpr uint8_t HEIGHT = 10;
+
+constexpr char letters[HEIGHT][WIDTH + 1] = {
+    "ITTISIMHALFE",
+    "AQUARTERNTEN",
+    "TWENTYDFIVED",
+    "PASTATOTEONE",
+    "TWELVETIMTWO",
+    "ATHREEENFOUR",
+    "FIVESIXDNINE",
+    "SEVENDAEIGHT",
+    "TENTELEVENET",
+    "IMO'CLOCKEAN"};
+
+enum
+{
+    IT,
+    IS,
+    A,
+    HALF,
+    QUARTER,
+    TEN,
+    TWENTY,
+    FIVE,
+    PAST,
+    TO,
+    HOUR_ONE,
+    HOUR_TWO,
+    HOUR_THREE,
+    HOUR_FOUR,
+    HOUR_FIVE,
+    HOUR_SIX,
+    HOUR_NINE,
+    HOUR_SEVEN,
+    HOUR_EIGHT,
+    HOUR_TEN,
+    HOUR_ELEVEN,
+    HOUR_TWELVE,
+    OCLOCK,
+    WORDS
+};
+
+constexpr FaceWord words[WORDS] = {
+    {0, 0, "IT"},
+    {0, 3, "IS"},
+    {0, 8, "A"},
+    {0, 7, "HALF"},
+    {1, 1, "QUARTER"},
+    {1, 9, "TEN"},
+    {2, 0, "TWENTY"},
+    {2, 7, "FIVE"},
+    {3, 0, "PAST"},
+    {3, 5, "TO"},
+    {3, 9, "ONE"},
+    {4, 9, "TWO"},
+    {5, 1, "THREE"},
+    {5, 8, "FOUR"},
+    {6, 0, "FIVE"},
+    {6, 4, "SIX"},
+    {6, 8, "NINE"},
+    {7, 0, "SEVEN"},
+    {7, 7, "EIGHT"},
+    {8, 0, "TEN"},
+    {8, 4, "ELEVEN"},
+    {4, 0, "TWELVE"},
+    {9, 2, "O'CLOCK"}};
+
+constexpr uint8_t hours[12] = {
+    HOUR_TWELVE,
+    HOUR_ONE,
+    HOUR_TWO,
+    HOUR_THREE,
+    HOUR_FOUR,
+    HOUR_FIVE,
+    HOUR_SIX,
+    HOUR_SEVEN,
+    HOUR_EIGHT,
+    HOUR_NINE,
+    HOUR_TEN,
+    HOUR_ELEVEN};
+
+constexpr uint32_t ALWAYS = FACE_WORD(IT) | FACE_WORD(IS);
+
+constexpr FaceSlot slots[12] = {
+    {FACE_WORD(OCLOCK), 0, hours},                                        // O'Clock
+    {FACE_WORD(FIVE) | FACE_WORD(PAST), 0, hours},                        // Five Past
+    {FACE_WORD(TEN) | FACE_WORD(PAST), 0, hours},                         // Ten Past
+    {FACE_WORD(A) | FACE_WORD(QUARTER) | FACE_WORD(PAST), 0, hours},      // Quarter Past
+    {FACE_WORD(TWENTY) | FACE_WORD(PAST), 0, hours},                      // Twenty Past
+    {FACE_WORD(TWENTY) | FACE_WORD(FIVE) | FACE_WORD(PAST), 0, hours},    // Twenty Five Past
+    {FACE_WORD(HALF) | FACE_WORD(PAST), 0, hours},                        // Half Past
+    {FACE_WORD(TWENTY) | FACE_WORD(FIVE) | FACE_WORD(TO), 1, hours},      // Twenty Five To
+    {FACE_WORD(TWENTY) | FACE_WORD(TO), 1, hours},                        // Twenty To
+    {FACE_WORD(A) | FACE_WORD(QUARTER) | FACE_WORD(TO), 1, hours},        // Quarter To
+    {FACE_WORD(TEN) | FACE_WORD(TO), 1, hours},                           // Ten To
+    {FACE_WORD(FIVE) | FACE_WORD(TO), 1, hours}};                         // Five To
+
+static_assert(faceSpellsWords(letters, words), "English words do not match its letters");
+static_assert(faceGrammarValid(slots, WORDS), "English phrases use unknown words");
+}
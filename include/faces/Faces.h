@@ -0,0 +1,5 @@
+#pragma once
+
+// Every face, so each one's checks run on every build whichever is selected
+#include "faces/English.h"
+#include "faces/German.h"
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Face.h"
+
+// German, 11 x 10
+//  E S K I S T A F Ü N F
+//  Z E H N Z W A N Z I G
+//  D R E I V I E R T E L
+//  V O R F U N K N A C H
+//  H A L B A E L F Ü N F
+//  E I N S X A M Z W E I
+//  D R E I P M J V I E R
+//  S E C H S N L A C H T
+//  S I E B E N Z W Ö L F
+//  Z E H N E U N K U H R
+//
+//  ES IST [FÜNF,ZEHN,VIERTEL,ZWANZIG] [NACH,VOR] [HALB] [EIN..ZWÖLF] [UHR]
+//  From 25 past the phrase counts toward the next hour ("fünf vor halb
+//  drei" is 2:25), and on the hour it is "EIN UHR" rather than "EINS".
+//  Umlauts are stored as their base letter, one cell each.
+namespace FaceGerman
+{
+constexpr uint8_t WIDTH = 11;
+constexpr uint8_t HEIGHT = 10;
+
+constexpr char letters[HEIGHT][WIDTH + 1] = {
+    "ESKISTAFUNF",
+    "ZEHNZWANZIG",
+    "DREIVIERTEL",
+    "VORFUNKNACH",
+    "HALBAELFUNF",
+    "EINSXAMZWEI",
+    "DREIPMJVIER",
+    "SECHSNLACHT",
+    "SIEBENZWOLF",
+    "ZEHNEUNKUHR"};
+
+enum
+{
+    ES,
+    IST,
+    FUENF,
+    ZEHN,
+    ZWANZIG,
+    VIERTEL,
+    VOR,
+    NACH,
+    HALB,
+    UHR,
+    HOUR_EIN,
+    HOUR_EINS,
+    HOUR_ZWEI,
+    HOUR_DREI,
+    HOUR_VIER,
+    HOUR_FUENF,
+    HOUR_SECHS,
+    HOUR_SIEBEN,
+    HOUR_ACHT,
+    HOUR_NEUN,
+    HOUR_ZEHN,
+    HOUR_ELF,
+    HOUR_ZWOELF,
+    WORDS
+};
+
+constexpr FaceWord words[WORDS] = {
+    {0, 0, "ES"},
+    {0, 3, "IST"},
+    {0, 7, "FUNF"},
+    {1, 0, "ZEHN"},
+    {1, 4, "ZWANZIG"},
+    {2, 4, "VIERTEL"},
+    {3, 0, "VOR"},
+    {3, 7, "NACH"},
+    {4, 0, "HALB"},
+    {9, 8, "UHR"},
+    {5, 0, "EIN"},
+    {5, 0, "EINS"},
+    {5, 7, "ZWEI"},
+    {6, 0, "DREI"},
+    {6, 7, "VIER"},
+    {4, 7, "FUNF"},
+    {7, 0, "SECHS"},
+    {8, 0, "SIEBEN"},
+    {7, 7, "ACHT"},
+    {9, 3, "NEUN"},
+    {9, 0, "ZEHN"},
+    {4, 5, "ELF"},
+    {8, 6, "ZWOLF"}};
+
+constexpr uint8_t hours[12] = {
+    HOUR_ZWOELF,
+    HOUR_EINS,
+    HOUR_ZWEI,
+    HOUR_DREI,
+    HOUR_VIER,
+    HOUR_FUENF,
+    HOUR_SECHS,
+    HOUR_SIEBEN,
+    HOUR_ACHT,
+    HOUR_NEUN,
+    HOUR_ZEHN,
+    HOUR_ELF};
+
+// "EIN UHR"
+constexpr uint8_t hoursOnTheHour[12] = {
+    HOUR_ZWOELF,
+    HOUR_EIN,
+    HOUR_ZWEI,
+    HOUR_DREI,
+    HOUR_VIER,
+    HOUR_FUENF,
+    HOUR_SECHS,
+    HOUR_SIEBEN,
+    HOUR_ACHT,
+    HOUR_NEUN,
+    HOUR_ZEHN,
+    HOUR_ELF};
+
+constexpr uint32_t ALWAYS = FACE_WORD(ES) | FACE_WORD(IST);
+
+constexpr FaceSlot slots[12] = {
+    {FACE_WORD(UHR), 0, hoursOnTheHour},                                  // Uhr
+    {FACE_WORD(FUENF) | FACE_WORD(NACH), 0, hours},                       // Fünf nach
+    {FACE_WORD(ZEHN) | FACE_WORD(NACH), 0, hours},                        // Zehn nach
+    {FACE_WORD(VIERTEL) | FACE_WORD(NACH), 0, hours},                     // Viertel nach
+    {FACE_WORD(ZWANZIG) | FACE_WORD(NACH), 0, hours},                     // Zwanzig nach
+    {FACE_WORD(FUENF) | FACE_WORD(VOR) | FACE_WORD(HALB), 1, hours},      // Fünf vor halb
+    {FACE_WORD(HALB), 1, hours},                                          // Halb
+    {FACE_WORD(FUENF) | FACE_WORD(NACH) | FACE_WORD(HALB), 1, hours},     // Fünf nach halb
+    {FACE_WORD(ZWANZIG) | FACE_WORD(VOR), 1, hours},                      // Zwanzig vor
+    {FACE_WORD(VIERTEL) | FACE_WORD(VOR), 1, hours},                      // Viertel vor
+    {FACE_WORD(ZEHN) | FACE_WORD(VOR), 1, hours},                         // Zehn vor
+    {FACE_WORD(FUENF) | FACE_WORD(VOR), 1, hours}};                       // Fünf vor
+
+static_assert(faceSpellsWords(letters, words), "German words do not match its letters");
+static_assert(faceGrammarValid(slots, WORDS), "German phrases use unknown words");
+}
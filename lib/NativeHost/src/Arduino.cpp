@@ -0,0 +1,141 @@
+#include <Arduino.h>
+
+#include <chrono>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+
+#include "NativeHal.h"
+
+HardwareSerial Serial;
+
+static const std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+static bool serialMuted = false;
+static int serialPeek = -1; // Byte read ahead from stdin, -1 for none
+
+// Analog inputs sit at mid scale until the host sets them
+struct AnalogInputs
+{
+    int value[32];
+    AnalogInputs()
+    {
+        for (uint8_t i = 0; i < 32; i++)
+        {
+            value[i] = 512;
+        }
+    }
+};
+static AnalogInputs analogInputs;
+
+// Time
+
+static uint64_t hostMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostStart).count();
+}
+
+static void hostSleep(uint64_t us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+static const HalClock hostClock = {hostMicros, hostSleep};
+static const HalClock *halClock = &hostClock;
+
+void halSetClock(const HalClock *clock)
+{
+    halClock = clock ? clock : &hostClock;
+}
+
+uint64_t halMicros64()
+{
+    return halClock->micros();
+}
+
+uint32_t micros()
+{
+    return (uint32_t)halMicros64();
+}
+
+uint32_t millis()
+{
+    return (uint32_t)(halMicros64() / 1000);
+}
+
+void delay(uint32_t ms)
+{
+    halClock->sleep((uint64_t)ms * 1000);
+}
+
+// Analog inputs
+
+int analogRead(uint8_t pin)
+{
+    return pin < 32 ? analogInputs.value[pin] : 0;
+}
+
+void halSetAnalog(uint8_t pin, int value)
+{
+    if (pin < 32)
+    {
+        analogInputs.value[pin] = value;
+    }
+}
+
+// Serial
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (serialMuted)
+    {
+        return 1;
+    }
+    return fwrite(&c, 1, 1, stdout);
+}
+
+// Whole writes go out at once, so binary output is not held back by line buffering
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (serialMuted)
+    {
+        return size;
+    }
+    size = fwrite(buffer, 1, size, stdout);
+    fflush(stdout);
+    return size;
+}
+
+// Input is taken from stdin without blocking
+int HardwareSerial::available()
+{
+    if (serialPeek >= 0)
+    {
+        return 1;
+    }
+    pollfd input = {STDIN_FILENO, POLLIN, 0};
+    uint8_t c;
+    if (::poll(&input, 1, 0) > 0 && (input.revents & POLLIN) && ::read(STDIN_FILENO, &c, 1) == 1)
+    {
+        serialPeek = c;
+        return 1;
+    }
+    return 0;
+}
+
+int HardwareSerial::peek()
+{
+    return available() ? serialPeek : -1;
+}
+
+int HardwareSerial::read()
+{
+    int c = peek();
+    serialPeek = -1;
+    return c;
+}
+
+void halSetSerialMuted(bool muted)
+{
+    serialMuted = muted;
+    fflush(stdout);
+}
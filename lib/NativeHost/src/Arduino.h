@@ -0,0 +1,96 @@
+#pragma once
+
+// Arduino core stand-in for the native build
+//  Only what the sketch uses: timing, analogRead and a Serial on stdout
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define A0 14
+#define F_CPU 48000000L // Reported CPU clock, kept at the SAMD21 value for cycle estimates
+
+typedef uint8_t byte;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+int analogRead(uint8_t pin);
+
+void setup();
+void loop();
+
+class Print
+{
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            write(buffer[i]);
+        }
+        return size;
+    }
+    size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char *str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(long value, int base = 10) { return printFormat(base == 16 ? "%lx" : "%ld", value); }
+    size_t print(unsigned long value, int base = 10) { return printFormat(base == 16 ? "%lx" : "%lu", value); }
+    size_t print(int value, int base = 10) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = 10) { return print((unsigned long)value, base); }
+    size_t print(unsigned char value, int base = 10) { return print((unsigned long)value, base); }
+    size_t print(double value, int digits = 2)
+    {
+        char buffer[40];
+        snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+        return write(buffer);
+    }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(T value) { return print(value) + println(); }
+    template <typename T>
+    size_t println(T value, int format) { return print(value, format) + println(); }
+
+private:
+    template <typename T>
+    size_t printFormat(const char *format, T value)
+    {
+        char buffer[34];
+        snprintf(buffer, sizeof(buffer), format, value);
+        return write(buffer);
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+// Serial on stdin/stdout, output can be muted by the host (see NativeHal.h)
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    int availableForWrite() override { return 256; }
+    explicit operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,587 @@
+#include <Arduino.h>
+#include <FastLED.h>
+
+#include <chrono>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Background.h"
+#include "NativeHal.h"
+#include "PanelMap.h"
+#include "RtcDiscipline.h"
+#include "TemporalDither.h"
+#include "TimeSnapshot.h"
+#include "TimeZone.h"
+#include "WS2812Encoder.h"
+#include "WordMask.h"
+
+// Frame benchmark suite
+//  Times each pipeline stage of the sketch on the host and reports ns/frame
+//  and instructions/frame. Fails when a stage goes over its budget, or over
+//  a saved baseline by more than the tolerance, or when the noise field or
+//  the WS2812 encoder give the wrong output.
+//
+//  program bench [--iterations N] [--save FILE] [--baseline FILE] [--tolerance PCT]
+
+// Sketch state and stages, from src/main.cpp
+extern CRGB leds[WC_LEDS];
+extern TemporalDither<WC_LEDS> dither;
+extern uint8_t brightness;
+extern RtcDiscipline discipline;
+extern TimeZone tz;
+extern TimeSnapshot timeNow;
+extern EffectEngine effects;
+void renderTask();
+void sensorTask();
+void updateBackground();
+void updateWC(const TimeSnapshot &now);
+
+const uint32_t BENCH_ITERATIONS = 2000;  // Frames per round
+const uint8_t BENCH_ROUNDS = 5;          // Best round is reported
+const uint32_t BENCH_EPOCH = 1672531200; // 2023-01-01 00:00:00 UTC, start of the timezone walk
+const uint32_t BENCH_TOLERANCE_PCT = 25; // Allowed growth over a baseline
+const uint8_t BENCH_MAX_STAGES = 32;
+
+struct BenchStage
+{
+    const char *name;
+    void (*run)(uint32_t i);
+    uint32_t budget_ns; // Ceiling per frame on any reasonable host, 0 for none
+};
+
+struct BenchResult
+{
+    const char *name;
+    uint32_t ns;           // Per frame, best round
+    uint32_t instructions; // Per frame in the best round, 0 when the counter is not available
+};
+
+static volatile uint32_t benchSink; // Keeps results of pure stages alive
+static TimeSnapshot benchSnapshot;
+static uint8_t benchStrip[WS2812_BUFFER_SIZE(WC_LEDS)];
+
+// Larger builds for the background kernels: a rotated 16x16 panel, 3x2
+// tiled 16x16 panels (48x32) and 2x2 tiled 32x32 panels (64x64)
+constexpr PanelLayout BENCH_PANEL_256 = {16, 16, 1, 1, PANEL_SERPENTINE, PANEL_ROTATE_90, false};
+constexpr PanelLayout BENCH_PANEL_1536 = {16, 16, 3, 2, PANEL_SERPENTINE, PANEL_ROTATE_180, true};
+constexpr PanelLayout BENCH_PANEL_4096 = {32, 32, 2, 2, PANEL_PROGRESSIVE, PANEL_ROTATE_270, true};
+static constexpr PanelMapTable<16, 16> benchMap256(BENCH_PANEL_256);
+static constexpr PanelMapTable<48, 32> benchMap1536(BENCH_PANEL_1536);
+static constexpr PanelMapTable<64, 64> benchMap4096(BENCH_PANEL_4096);
+static_assert(benchMap256.complete() && benchMap1536.complete() && benchMap4096.complete(),
+              "Benchmark panels do not cover their grids");
+static CRGB benchLeds[64 * 64];
+static NoiseField<noiseFieldSide(rainbowSpan(64))> benchField4096; // Covers the 64x64 grid at the default spacing
+
+// Stages
+
+static void benchBackground(uint32_t)
+{
+    updateBackground();
+}
+
+// Walk through every 5 minute slot of the day
+static void benchWordClock(uint32_t i)
+{
+    benchSnapshot.time.hour = (i / 60) % 24;
+    benchSnapshot.time.minute = i % 60;
+    updateWC(benchSnapshot);
+}
+
+// Step a bit over an hour per frame, crossing DST changes and years
+static void benchTimeZone(uint32_t i)
+{
+    DateTime time;
+    uint32_t utc = BENCH_EPOCH + i * 3607;
+    breakTime(tz.toLocal(utc), time);
+    benchSink = time.hour + tz.isDST(utc);
+}
+
+static void benchSnapshotRead(uint32_t)
+{
+    readTimeSnapshot(discipline, tz, timeNow);
+}
+
+// Slow sweep of the knob, a full turn every 4096 samples
+static void benchBrightness(uint32_t i)
+{
+    halSetAnalog(A0, (i / 4) & 1023);
+    sensorTask();
+}
+
+static void benchLatch(uint32_t)
+{
+    dither.latch(leds, brightness);
+}
+
+static void benchRefresh(uint32_t)
+{
+    dither.refresh(leds);
+}
+
+static void benchEncode(uint32_t)
+{
+    static const uint8_t scale[3] = {255, 255, 255};
+    ws2812Encode(leds[0].raw, WC_LEDS, scale, benchStrip);
+}
+
+static void benchFrame(uint32_t)
+{
+    renderTask();
+}
+
+// Rainbow walk in grid order, writing leds[] wherever the map points.
+// Same pixels as rainbowWalk(), kept to compare against strip order.
+static void rainbowWalkGrid(CRGB *out, const PanelView &panel, uint32_t step)
+{
+    uint16_t angle = (step % 1024) << 6;
+    int32_t c = cos16(angle);
+    int32_t s = sin16(angle);
+    int32_t x_row = (panel.width * 32) * c - (panel.height * 32) * s;
+    int32_t y_row = (panel.height * 32) * c + (panel.width * 32) * s;
+    for (uint16_t y = 0; y < panel.height; y++)
+    {
+        int32_t x_rot = x_row;
+        int32_t y_rot = y_row;
+        for (uint16_t x = 0; x < panel.width; x++)
+        {
+            CRGB &led = out[panel.index[y * panel.width + x]];
+            led.setHue(inoise16((uint32_t)(x_rot >> 15), (uint32_t)(y_rot >> 15)));
+            led.fadeToBlackBy(192);
+            x_rot += 8 * c;
+            y_rot += 8 * s;
+        }
+        x_row -= 8 * s;
+        y_row += 8 * c;
+    }
+}
+
+// One background effect on the face, through the engine as on the device
+template <uint8_t EFFECT>
+static void benchEffect(uint32_t i)
+{
+    if (effects.current() != EFFECT)
+    {
+        effects.select(EFFECT, ledMap.view());
+    }
+    effects.render(leds, ledMap.view(), {i, 160});
+}
+
+static void benchGrid256(uint32_t i)
+{
+    rainbowWalkGrid(benchLeds, benchMap256.view(), i);
+}
+
+static void benchStrip256(uint32_t i)
+{
+    rainbowWalk(benchLeds, benchMap256.view(), i);
+}
+
+static void benchGrid1536(uint32_t i)
+{
+    rainbowWalkGrid(benchLeds, benchMap1536.view(), i);
+}
+
+static void benchStrip1536(uint32_t i)
+{
+    rainbowWalk(benchLeds, benchMap1536.view(), i);
+}
+
+static void benchGrid4096(uint32_t i)
+{
+    rainbowWalkGrid(benchLeds, benchMap4096.view(), i);
+}
+
+static void benchStrip4096(uint32_t i)
+{
+    rainbowWalk(benchLeds, benchMap4096.view(), i);
+}
+
+static void benchCached4096(uint32_t i)
+{
+    rainbowWalk(benchLeds, benchMap4096.view(), i, benchField4096);
+}
+
+// Noise field accuracy
+//  Largest difference between cached and exact noise over a full turn of
+//  the rainbow walk.
+template <uint8_t N>
+static uint16_t noiseFieldError(const PanelView &panel, NoiseField<N> &field)
+{
+    if (!field.begin(rainbowRadius(panel)))
+    {
+        return UINT16_MAX;
+    }
+    while (field.refresh())
+    {
+    }
+    uint16_t worst = 0;
+    for (uint32_t step = 0; step < 1024; step++)
+    {
+        rainbowKernel(benchLeds, panel, step, [&](int32_t x, int32_t y) {
+            uint16_t exact = inoise16((uint32_t)x, (uint32_t)y);
+            uint16_t error = abs((int32_t)field.sample(x, y) - exact);
+            worst = error > worst ? error : worst;
+            return exact;
+        });
+    }
+    return worst;
+}
+
+// WS2812 encoding
+//  Known pixels against SPI bytes written out by hand, then random pixels
+//  and scales against a bit by bit reference, then the reset after them.
+//  Returns the number of bytes that differ.
+struct EncodeCase
+{
+    uint8_t rgb[3];
+    uint8_t scale[3];
+    uint8_t spi[WS2812_BYTES_PER_PIXEL]; // G, R, B
+};
+
+static const EncodeCase encodeCases[] = {
+    // All zeros, 100 for every bit
+    {{0x00, 0x00, 0x00}, {255, 255, 255}, {0x92, 0x49, 0x24, 0x92, 0x49, 0x24, 0x92, 0x49, 0x24}},
+    // All ones in red only, 110 for every bit, sent second
+    {{0xFF, 0x00, 0x00}, {255, 255, 255}, {0x92, 0x49, 0x24, 0xDB, 0x6D, 0xB6, 0x92, 0x49, 0x24}},
+    // Green first, blue last, MSB first
+    {{0x00, 0x80, 0x01}, {255, 255, 255}, {0xD2, 0x49, 0x24, 0x92, 0x49, 0x24, 0x92, 0x49, 0x26}},
+    // Scaled per channel, 255 -> 128, 64 and 0
+    {{0xFF, 0xFF, 0xFF}, {128, 64, 0}, {0x9A, 0x49, 0x24, 0xD2, 0x49, 0x24, 0x92, 0x49, 0x24}},
+    // Scale 0 blanks, scale 255 keeps the value
+    {{0x5A, 0xA5, 0x3C}, {0, 255, 255}, {0xD3, 0x49, 0xA6, 0x92, 0x49, 0x24, 0x93, 0x6D, 0xA4}},
+};
+
+// Three SPI bits per data bit, written one at a time
+static void encodeReference(const uint8_t *rgb, const uint8_t scale[3], uint8_t *out)
+{
+    const uint8_t order[3] = {1, 0, 2};
+    uint16_t bit = 0;
+    memset(out, 0, WS2812_BYTES_PER_PIXEL);
+    for (uint8_t c = 0; c < 3; c++)
+    {
+        uint8_t value = scale8(rgb[order[c]], scale[order[c]]);
+        for (int8_t b = 7; b >= 0; b--)
+        {
+            uint8_t pattern = ((value >> b) & 1) ? 0b110 : 0b100;
+            for (int8_t p = 2; p >= 0; p--, bit++)
+            {
+                out[bit / 8] |= ((pattern >> p) & 1) << (7 - bit % 8);
+            }
+        }
+    }
+}
+
+static uint32_t ws2812Errors()
+{
+    const uint8_t cases = sizeof(encodeCases) / sizeof(encodeCases[0]);
+    uint8_t out[WS2812_BUFFER_SIZE(64) + 1];
+    uint32_t errors = 0;
+    for (uint8_t i = 0; i < cases; i++)
+    {
+        ws2812Encode(encodeCases[i].rgb, 1, encodeCases[i].scale, out);
+        errors += memcmp(out, encodeCases[i].spi, WS2812_BYTES_PER_PIXEL) != 0;
+    }
+
+    uint8_t rgb[64 * 3];
+    for (uint16_t i = 0; i < sizeof(rgb); i++)
+    {
+        rgb[i] = random8();
+    }
+    const uint8_t scale[3] = {random8(), random8(), 255};
+    memset(out, 0xAA, sizeof(out));
+    ws2812Encode(rgb, 64, scale, out);
+    uint16_t len = ws2812Reset(out, 64);
+    for (uint16_t i = 0; i < 64; i++)
+    {
+        uint8_t expected[WS2812_BYTES_PER_PIXEL];
+        encodeReference(rgb + i * 3, scale, expected);
+        for (uint8_t b = 0; b < WS2812_BYTES_PER_PIXEL; b++)
+        {
+            errors += out[i * WS2812_BYTES_PER_PIXEL + b] != expected[b];
+        }
+    }
+
+    // The reset is all low, long enough to latch, and nothing is written past it
+    errors += len != WS2812_BUFFER_SIZE(64);
+    for (uint16_t i = 64 * WS2812_BYTES_PER_PIXEL; i < len; i++)
+    {
+        errors += out[i] != 0;
+    }
+    errors += out[len] != 0xAA;
+    errors += (uint32_t)WS2812_RESET_BYTES * 8 * 1000000 / WS2812_SPI_HZ < 280;
+    return errors;
+}
+
+// Budgets are loose on purpose, they catch order of magnitude mistakes on
+// any host, the baseline file catches smaller regressions on one host.
+static const BenchStage benchStages[] = {
+    {"background", benchBackground, 25000},
+    {"wordclock", benchWordClock, 500},
+    {"timezone", benchTimeZone, 500},
+    {"snapshot", benchSnapshotRead, 1000},
+    {"brightness", benchBrightness, 100},
+    {"dither-latch", benchLatch, 1000},
+    {"dither-refresh", benchRefresh, 2000},
+    {"ws2812-encode", benchEncode, 5000},
+    {"frame", benchFrame, 30000},
+    {"fx-rainbow", benchEffect<EFFECT_RAINBOW>, 25000},
+    {"fx-plasma", benchEffect<EFFECT_PLASMA>, 25000},
+    {"fx-fire", benchEffect<EFFECT_FIRE>, 25000},
+    {"fx-starfield", benchEffect<EFFECT_STARFIELD>, 25000},
+    {"fx-twinkle", benchEffect<EFFECT_TWINKLE>, 25000},
+    {"fx-solid", benchEffect<EFFECT_SOLID>, 25000},
+    {"bg-256-grid", benchGrid256, 50000},
+    {"bg-256-strip", benchStrip256, 50000},
+    {"bg-1536-grid", benchGrid1536, 300000},
+    {"bg-1536-strip", benchStrip1536, 300000},
+    {"bg-4096-grid", benchGrid4096, 800000},
+    {"bg-4096-strip", benchStrip4096, 800000},
+    {"bg-4096-cached", benchCached4096, 800000},
+};
+const uint8_t BENCH_STAGES = sizeof(benchStages) / sizeof(benchStages[0]);
+static_assert(BENCH_STAGES <= BENCH_MAX_STAGES, "Raise BENCH_MAX_STAGES");
+
+// Instruction counter
+
+static int perfFd = -1;
+
+static void perfOpen()
+{
+#ifdef __linux__
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perfFd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+static void perfStart()
+{
+#ifdef __linux__
+    if (perfFd >= 0)
+    {
+        ioctl(perfFd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(perfFd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+static uint64_t perfStop()
+{
+    uint64_t count = 0;
+#ifdef __linux__
+    if (perfFd >= 0)
+    {
+        ioctl(perfFd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(perfFd, &count, sizeof(count)) != sizeof(count))
+        {
+            count = 0;
+        }
+    }
+#endif
+    return count;
+}
+
+// Run one stage, best of BENCH_ROUNDS rounds
+static BenchResult runStage(const BenchStage &stage, uint32_t iterations)
+{
+    BenchResult result = {stage.name, UINT32_MAX, UINT32_MAX};
+
+    // Warm caches and the word layer
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        stage.run(i);
+    }
+
+    for (uint8_t round = 0; round < BENCH_ROUNDS; round++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        perfStart();
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            stage.run(i);
+        }
+        uint64_t instructions = perfStop();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        uint32_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / iterations;
+        if (ns < result.ns)
+        {
+            result.ns = ns;
+            result.instructions = instructions / iterations;
+        }
+    }
+    return result;
+}
+
+// Baseline file, one "name ns instructions" line per stage
+
+static bool saveBaseline(const char *path, const BenchResult *results, uint8_t count)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++)
+    {
+        fprintf(file, "%s %u %u\n", results[i].name, results[i].ns, results[i].instructions);
+    }
+    return fclose(file) == 0;
+}
+
+static bool findBaseline(FILE *file, const char *name, BenchResult &baseline)
+{
+    char stage[32];
+    rewind(file);
+    while (fscanf(file, "%31s %u %u", stage, &baseline.ns, &baseline.instructions) == 3)
+    {
+        if (strcmp(stage, name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool overLimit(uint32_t value, uint32_t limit, uint32_t tolerance_pct)
+{
+    return limit && (uint64_t)value * 100 > (uint64_t)limit * (100 + tolerance_pct);
+}
+
+int runBenchmarks(int argc, char **argv)
+{
+    uint32_t iterations = BENCH_ITERATIONS;
+    uint32_t tolerance_pct = BENCH_TOLERANCE_PCT;
+    const char *save_path = nullptr;
+    const char *baseline_path = nullptr;
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--iterations") == 0)
+        {
+            iterations = atoi(argv[i + 1]) > 0 ? atoi(argv[i + 1]) : 1;
+        }
+        else if (strcmp(argv[i], "--tolerance") == 0)
+        {
+            tolerance_pct = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--save") == 0)
+        {
+            save_path = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--baseline") == 0)
+        {
+            baseline_path = argv[i + 1];
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    FILE *baseline_file = nullptr;
+    if (baseline_path && !(baseline_file = fopen(baseline_path, "r")))
+    {
+        fprintf(stderr, "Cannot read baseline %s\n", baseline_path);
+        return 2;
+    }
+
+    // Bring the sketch up as on the device, quietly
+    halSetSerialMuted(true);
+    setup();
+    halSetSerialMuted(false);
+
+    // Check the noise field first, which also fills benchField4096 before it is timed
+    static NoiseField<RAINBOW_LATTICE> face_field;
+    uint16_t face_error = noiseFieldError(ledMap.view(), face_field);
+    uint16_t large_error = noiseFieldError(benchMap4096.view(), benchField4096);
+    bool noise_failed = face_error > NOISE_FIELD_MAX_ERROR || large_error > NOISE_FIELD_MAX_ERROR;
+    uint32_t encode_errors = ws2812Errors();
+
+    perfOpen();
+    printf("%-16s %10s %14s %10s  %s\n", "stage", "ns/frame", "instr/frame", "budget", "status");
+
+    BenchResult results[BENCH_MAX_STAGES];
+    uint8_t failures = 0;
+    for (uint8_t i = 0; i < BENCH_STAGES; i++)
+    {
+        const BenchStage &stage = benchStages[i];
+        BenchResult &result = results[i];
+        result = runStage(stage, iterations);
+
+        const char *status = "ok";
+        BenchResult baseline;
+        if (overLimit(result.ns, stage.budget_ns, 0))
+        {
+            status = "OVER BUDGET";
+        }
+        else if (baseline_file && findBaseline(baseline_file, stage.name, baseline))
+        {
+            if (overLimit(result.instructions, result.instructions ? baseline.instructions : 0, tolerance_pct))
+            {
+                status = "REGRESSED (instructions)";
+            }
+            else if (overLimit(result.ns, baseline.ns, tolerance_pct))
+            {
+                status = "REGRESSED (time)";
+            }
+        }
+        if (strcmp(status, "ok") != 0)
+        {
+            failures++;
+        }
+
+        char instructions[16] = "n/a";
+        if (result.instructions)
+        {
+            snprintf(instructions, sizeof(instructions), "%u", result.instructions);
+        }
+        printf("%-16s %10u %14s %10u  %s\n", result.name, result.ns, instructions, stage.budget_ns, status);
+    }
+
+    printf("noise field error: face %u, 4096 LEDs %u, bound %u  %s\n", face_error, large_error,
+           NOISE_FIELD_MAX_ERROR, noise_failed ? "OVER BOUND" : "ok");
+    if (noise_failed)
+    {
+        failures++;
+    }
+    printf("ws2812 encoding: %u known pixels, 64 random, reset %u bytes, %u bytes wrong  %s\n",
+           (unsigned)(sizeof(encodeCases) / sizeof(encodeCases[0])), WS2812_RESET_BYTES, encode_errors,
+           encode_errors ? "FAILED" : "ok");
+    if (encode_errors)
+    {
+        failures++;
+    }
+    if (perfFd < 0)
+    {
+        printf("Instruction counter not available, time only\n");
+    }
+    if (baseline_file)
+    {
+        fclose(baseline_file);
+    }
+    if (save_path && !saveBaseline(save_path, results, BENCH_STAGES))
+    {
+        fprintf(stderr, "Cannot write baseline %s\n", save_path);
+        return 2;
+    }
+    if (failures)
+    {
+        printf("%u stage(s) regressed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <Arduino.h>
+
+#include <stdlib.h>
+
+#include "DriftEstimator.h"
+#include "NativeHal.h"
+#include "RtcDiscipline.h"
+
+// Drift estimator check
+//  Feeds a DriftEstimator the offsets an RTC with a known rate would build
+//  up between syncs, at the intervals it asks for, with the correction it
+//  gives applied and measurement jitter added. Checks the estimate, the
+//  sync interval, that single bad offsets are dropped while a real change
+//  in drift is followed, and the FREQCORR values the estimate maps to.
+//
+//  program drift [--jitter MS] [--seed S]
+
+const uint32_t DRIFT_CHECK_JITTER_MS = 40; // Offset measurement error, uniform either way
+const uint8_t DRIFT_CHECK_SYNCS = 30;      // Syncs to settle
+const int32_t DRIFT_CHECK_TOLERANCE_PPB = 25; // Allowed estimate error per ms of jitter
+
+static uint32_t driftSeed = 1;
+static uint32_t driftJitter = DRIFT_CHECK_JITTER_MS;
+static uint32_t driftFailures = 0;
+
+// xorshift32
+static uint32_t driftRandom(uint32_t limit)
+{
+    driftSeed ^= driftSeed << 13;
+    driftSeed ^= driftSeed >> 17;
+    driftSeed ^= driftSeed << 5;
+    return driftSeed % limit;
+}
+
+static void check(bool ok, const char *what)
+{
+    printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+    driftFailures += ok ? 0 : 1;
+}
+
+// One sync against an RTC running rate_ppb fast, extra_ms added to the
+// measured offset
+static void sync(DriftEstimator &drift, int32_t rate_ppb, int32_t extra_ms = 0)
+{
+    uint32_t interval_s = drift.syncInterval();
+    int32_t applied_ppb = drift.ppb();
+    int32_t jitter_ms = (int32_t)driftRandom(driftJitter * 2 + 1) - (int32_t)driftJitter;
+    int32_t offset_ms = (int64_t)(applied_ppb - rate_ppb) * interval_s / 1000000 + jitter_ms + extra_ms;
+    drift.addSample(interval_s, offset_ms, applied_ppb);
+}
+
+static void settle(DriftEstimator &drift, int32_t rate_ppb, uint8_t syncs)
+{
+    for (uint8_t i = 0; i < syncs; i++)
+    {
+        sync(drift, rate_ppb);
+    }
+}
+
+// Offsets are whole milliseconds, worth this much over the shortest interval
+// on top of the jitter
+static bool near(int32_t ppb, int32_t expected)
+{
+    int32_t tolerance = DRIFT_CHECK_TOLERANCE_PPB * (int32_t)driftJitter + 1000000 / DRIFT_MIN_INTERVAL_S;
+    return abs(ppb - expected) <= tolerance;
+}
+
+static void checkSteady(int32_t rate_ppb, const char *name)
+{
+    DriftEstimator drift;
+    settle(drift, rate_ppb, DRIFT_CHECK_SYNCS);
+    char line[96];
+    snprintf(line, sizeof(line), "%s %d ppb: estimate %d ppb, interval %u s", name, rate_ppb, drift.ppb(),
+             drift.syncInterval());
+    check(near(drift.ppb(), rate_ppb) && drift.syncInterval() == DRIFT_MAX_INTERVAL_S && !drift.outliers(), line);
+}
+
+// A reply 3 s off, then the sync after it where the clock set from it
+// comes back by the same amount. Both have to be dropped.
+static void checkOutliers(int32_t rate_ppb)
+{
+    DriftEstimator drift;
+    settle(drift, rate_ppb, DRIFT_CHECK_SYNCS);
+    sync(drift, rate_ppb, 3000);
+    int32_t held = drift.ppb();
+    bool soon = drift.syncInterval() == DRIFT_MIN_INTERVAL_S;
+    sync(drift, rate_ppb, -3000);
+    settle(drift, rate_ppb, 2);
+    char line[96];
+    snprintf(line, sizeof(line), "3 s bad reply and its echo: %u outliers, estimate %d ppb", drift.outliers(),
+             drift.ppb());
+    check(drift.outliers() == 2 && near(held, rate_ppb) && near(drift.ppb(), rate_ppb) && soon, line);
+    settle(drift, rate_ppb, DRIFT_CHECK_SYNCS);
+    snprintf(line, sizeof(line), "after the outliers: interval back to %u s", drift.syncInterval());
+    check(drift.syncInterval() == DRIFT_MAX_INTERVAL_S, line);
+}
+
+// A change large enough to leave a residual over DRIFT_BAD_MS restarts the
+// estimate once the next sync confirms it, a small one is tracked
+static void checkChange(int32_t from_ppb, int32_t to_ppb, uint8_t syncs)
+{
+    DriftEstimator drift;
+    settle(drift, from_ppb, DRIFT_CHECK_SYNCS);
+    settle(drift, to_ppb, syncs);
+    char line[96];
+    snprintf(line, sizeof(line), "drift %d to %d ppb: estimate %d ppb after %u syncs", from_ppb, to_ppb,
+             drift.ppb(), syncs);
+    check(near(drift.ppb(), to_ppb) && !drift.outliers(), line);
+}
+
+// The hardware share is within a step of the estimate, or at the limit
+// with the same sign. Software makes up the rest.
+static void checkFreqCorr(int32_t ppb, uint8_t expected)
+{
+    const int32_t range_ppb = RTC_FREQCORR_MAX * RTC_FREQCORR_PPB;
+    uint8_t freqcorr = rtcFreqCorr(ppb);
+    int32_t hw_ppb = rtcFreqCorrPpb(freqcorr);
+    bool share = abs(ppb) <= range_ppb ? abs(ppb - hw_ppb) < RTC_FREQCORR_PPB
+                                       : hw_ppb == (ppb < 0 ? -range_ppb : range_ppb);
+    char line[96];
+    snprintf(line, sizeof(line), "FREQCORR for %d ppb: 0x%02x, %d ppb in hardware", ppb, freqcorr, hw_ppb);
+    check(freqcorr == expected && share, line);
+}
+
+int runDriftCheck(int argc, char **argv)
+{
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--jitter") == 0)
+        {
+            driftJitter = strtoul(argv[i + 1], nullptr, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            driftSeed = strtoul(argv[i + 1], nullptr, 0) | 1;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (driftJitter >= DRIFT_GOOD_MS)
+    {
+        fprintf(stderr, "Jitter has to stay under %u ms\n", DRIFT_GOOD_MS);
+        return 2;
+    }
+
+    checkSteady(37500, "crystal, fast");
+    checkSteady(-12000, "crystal, slow");
+    checkSteady(20000000, "internal oscillator 2% fast,");
+    checkOutliers(37500);
+    checkChange(37500, 12000, 6);
+    checkChange(37500, 40500, 8);
+
+    checkFreqCorr(0, 0x00);
+    checkFreqCorr(953, 0x00);
+    checkFreqCorr(954, 0x01);
+    checkFreqCorr(37500, 39);
+    checkFreqCorr(-37500, RTC_FREQCORR_NEGATIVE | 39);
+    checkFreqCorr(121158, RTC_FREQCORR_MAX);
+    checkFreqCorr(20000000, RTC_FREQCORR_MAX);
+    checkFreqCorr(-20000000, RTC_FREQCORR_NEGATIVE | RTC_FREQCORR_MAX);
+
+    if (driftFailures)
+    {
+        printf("%u check(s) failed\n", driftFailures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include <FastLED.h>
+
+#include "NativeHal.h"
+
+CFastLED FastLED;
+
+const uint16_t MAX_SHOWN_LEDS = 1024; // Largest frame kept for the host
+
+static CRGB shownFrame[MAX_SHOWN_LEDS];
+static uint16_t shownCount = 0;
+static uint32_t showCount = 0;
+
+// Math, same integer approximations as FastLED
+
+// sin16 from FastLED's lib8tion, 8 linear segments per quarter wave
+int16_t sin16(uint16_t theta)
+{
+    static const uint16_t base[] = {0, 6393, 12539, 18204, 23170, 27245, 30273, 32137};
+    static const uint8_t slope[] = {49, 48, 44, 38, 31, 23, 14, 4};
+
+    uint16_t offset = (theta & 0x3FFF) >> 3;
+    if (theta & 0x4000)
+    {
+        offset = 2047 - offset;
+    }
+    uint8_t section = offset / 256;
+    uint8_t secoffset8 = (uint8_t)(offset) / 2;
+    int16_t y = slope[section] * secoffset8 + base[section];
+    if (theta & 0x8000)
+    {
+        y = -y;
+    }
+    return y;
+}
+
+// sin8 from FastLED's lib8tion, 4 linear segments per quarter wave
+uint8_t sin8(uint8_t theta)
+{
+    static const uint8_t b_m16[] = {0, 49, 49, 41, 90, 27, 117, 10};
+
+    uint8_t offset = theta;
+    if (theta & 0x40)
+    {
+        offset = 255 - offset;
+    }
+    offset &= 0x3F;
+    uint8_t secoffset = offset & 0x0F;
+    if (theta & 0x40)
+    {
+        secoffset++;
+    }
+    uint8_t section = offset >> 4;
+    uint8_t b = b_m16[section * 2];
+    uint8_t m16 = b_m16[section * 2 + 1];
+    uint8_t mx = (m16 * secoffset) >> 4;
+    int8_t y = mx + b;
+    if (theta & 0x80)
+    {
+        y = -y;
+    }
+    return y + 128;
+}
+
+uint16_t rand16seed = 1337;
+
+// Black through red, orange and yellow to white, from FastLED's colorutils
+CRGB HeatColor(uint8_t temperature)
+{
+    uint8_t t192 = scale8_video(temperature, 191);
+    uint8_t heatramp = (t192 & 0x3F) << 2;
+    if (t192 & 0x80)
+    {
+        return CRGB(255, 255, heatramp);
+    }
+    if (t192 & 0x40)
+    {
+        return CRGB(255, heatramp, 0);
+    }
+    return CRGB(heatramp, 0, 0);
+}
+
+// Ken Perlin's permutation table, with the first entry repeated at the end
+static const uint8_t perm[] = {
+    151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225, 140, 36, 103, 30, 69, 142, 8, 99, 37, 240,
+    21, 10, 23, 190, 6, 148, 247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117, 35, 11, 32, 57, 177, 33, 88,
+    237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175, 74, 165, 71, 134, 139, 48, 27, 166, 77, 146, 158, 231, 83,
+    111, 229, 122, 60, 211, 133, 230, 220, 105, 92, 41, 55, 46, 245, 40, 244, 102, 143, 54, 65, 25, 63, 161, 1, 216,
+    80, 73, 209, 76, 132, 187, 208, 89, 18, 169, 200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186,
+    3, 64, 52, 217, 226, 250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212, 207, 206, 59, 227, 47, 16, 58,
+    17, 182, 189, 28, 42, 223, 183, 170, 213, 119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43, 172, 9,
+    129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104, 218, 246, 97, 228, 251, 34, 242, 193,
+    238, 210, 144, 12, 191, 179, 162, 241, 81, 51, 145, 235, 249, 14, 239, 107, 49, 192, 214, 31, 181, 199, 106, 157,
+    184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254, 138, 236, 205, 93, 222, 114, 67, 29, 24, 72, 243, 141, 128,
+    195, 78, 66, 215, 61, 156, 180, 151};
+
+static inline uint8_t permute(uint16_t x)
+{
+    return perm[x & 0xFF];
+}
+
+static int16_t grad16(uint8_t hash, int16_t x, int16_t y)
+{
+    hash &= 7;
+    int16_t u = hash < 4 ? x : y;
+    int16_t v = hash < 4 ? y : x;
+    if (hash & 1)
+    {
+        u = -u;
+    }
+    if (hash & 2)
+    {
+        v = -v;
+    }
+    return (u >> 1) + (v >> 1) + (u & 1);
+}
+
+static uint16_t ease16(uint16_t i)
+{
+    uint16_t j = (i & 0x8000) ? 65535 - i : i;
+    uint32_t jj = ((uint32_t)j * j) >> 15;
+    if (i & 0x8000)
+    {
+        jj = 65535 - jj;
+    }
+    return jj;
+}
+
+static int16_t lerp15by16(int16_t a, int16_t b, uint16_t frac)
+{
+    return a + (int16_t)(((int32_t)(b - a) * frac) >> 16);
+}
+
+// 2D Perlin noise, 16.16 fixed point inputs
+uint16_t inoise16(uint32_t x, uint32_t y)
+{
+    uint16_t X = x >> 16;
+    uint16_t Y = y >> 16;
+    uint8_t AA = permute(permute(X) + Y);
+    uint8_t AB = permute(permute(X) + Y + 1);
+    uint8_t BA = permute(permute(X + 1) + Y);
+    uint8_t BB = permute(permute(X + 1) + Y + 1);
+
+    uint16_t u = x & 0xFFFF;
+    uint16_t v = y & 0xFFFF;
+    int16_t xx = (u >> 1) & 0x7FFF;
+    int16_t yy = (v >> 1) & 0x7FFF;
+    int16_t N = 0x8000;
+    u = ease16(u);
+    v = ease16(v);
+
+    int16_t X1 = lerp15by16(grad16(AA, xx, yy), grad16(BA, xx - N, yy), u);
+    int16_t X2 = lerp15by16(grad16(AB, xx, yy - N), grad16(BB, xx - N, yy - N), u);
+    int32_t ans = lerp15by16(X1, X2, v) + 17308L;
+    return (uint32_t)ans * 484L >> 8;
+}
+
+// Full saturation and value hue, 6 sectors
+CRGB &CRGB::setHue(uint8_t hue)
+{
+    uint8_t sector = hue / 43;
+    uint8_t rem = (hue - sector * 43) * 6;
+    switch (sector)
+    {
+    case 0:
+        return setRGB(255, rem, 0);
+    case 1:
+        return setRGB(255 - rem, 255, 0);
+    case 2:
+        return setRGB(0, 255, rem);
+    case 3:
+        return setRGB(0, 255 - rem, 255);
+    case 4:
+        return setRGB(rem, 0, 255);
+    default:
+        return setRGB(255, 0, 255 - rem);
+    }
+}
+
+// Output
+
+void CFastLED::show()
+{
+    if (m_controller)
+    {
+        m_controller->show(m_data, m_count, CRGB(m_brightness, m_brightness, m_brightness));
+    }
+}
+
+void CFastLED::delay(unsigned long ms)
+{
+    uint32_t start = millis();
+    do
+    {
+        show();
+    } while (millis() - start < ms);
+}
+
+void NativeLedController::showColor(const CRGB &data, int nLeds, CRGB scale)
+{
+    shownCount = nLeds < MAX_SHOWN_LEDS ? nLeds : MAX_SHOWN_LEDS;
+    for (uint16_t i = 0; i < shownCount; i++)
+    {
+        shownFrame[i].r = (data.r * (scale.r + 1)) >> 8;
+        shownFrame[i].g = (data.g * (scale.g + 1)) >> 8;
+        shownFrame[i].b = (data.b * (scale.b + 1)) >> 8;
+    }
+    showCount++;
+}
+
+void NativeLedController::show(const CRGB *data, int nLeds, CRGB scale)
+{
+    shownCount = nLeds < MAX_SHOWN_LEDS ? nLeds : MAX_SHOWN_LEDS;
+    for (uint16_t i = 0; i < shownCount; i++)
+    {
+        shownFrame[i].r = (data[i].r * (scale.r + 1)) >> 8;
+        shownFrame[i].g = (data[i].g * (scale.g + 1)) >> 8;
+        shownFrame[i].b = (data[i].b * (scale.b + 1)) >> 8;
+    }
+    showCount++;
+}
+
+uint32_t halShowCount()
+{
+    return showCount;
+}
+
+const CRGB *halLedFrame()
+{
+    return shownFrame;
+}
+
+uint16_t halLedCount()
+{
+    return shownCount;
+}
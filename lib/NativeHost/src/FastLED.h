@@ -0,0 +1,162 @@
+#pragma once
+
+// FastLED stand-in for the native build
+//  The colour types and the math the sketch uses (sin8/sin16/cos16,
+//  inoise16, setHue, the 8-bit helpers, random and HeatColor) follow
+//  FastLED's integer versions so frames match the device.
+
+#include <Arduino.h>
+
+struct CRGB
+{
+    union
+    {
+        struct
+        {
+            uint8_t r, g, b;
+        };
+        uint8_t raw[3];
+    };
+
+    enum HTMLColorCode
+    {
+        Black = 0x000000,
+        White = 0xFFFFFF
+    };
+
+    CRGB() {}
+    CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    CRGB(HTMLColorCode color) : r((color >> 16) & 0xFF), g((color >> 8) & 0xFF), b(color & 0xFF) {}
+
+    uint8_t &operator[](uint8_t i) { return raw[i]; }
+    const uint8_t &operator[](uint8_t i) const { return raw[i]; }
+
+    CRGB &setRGB(uint8_t nr, uint8_t ng, uint8_t nb)
+    {
+        r = nr;
+        g = ng;
+        b = nb;
+        return *this;
+    }
+    CRGB &setHue(uint8_t hue);
+    CRGB &nscale8(uint8_t scale)
+    {
+        r = (r * (scale + 1)) >> 8;
+        g = (g * (scale + 1)) >> 8;
+        b = (b * (scale + 1)) >> 8;
+        return *this;
+    }
+    CRGB &fadeToBlackBy(uint8_t fade) { return nscale8(255 - fade); }
+};
+
+template <int N>
+struct CRGBArray
+{
+    CRGB entries[N];
+    CRGB &operator[](int i) { return entries[i]; }
+};
+
+struct CHSV
+{
+    uint8_t h, s, v;
+    CHSV(uint8_t ih, uint8_t is, uint8_t iv) : h(ih), s(is), v(iv) {}
+};
+
+enum EOrder
+{
+    RGB = 0012,
+    GRB = 0102
+};
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER>
+class WS2812B
+{
+};
+
+int16_t sin16(uint16_t theta);
+static inline int16_t cos16(uint16_t theta) { return sin16(theta + 16384); }
+uint8_t sin8(uint8_t theta);
+static inline uint8_t cos8(uint8_t theta) { return sin8(theta + 64); }
+uint16_t inoise16(uint32_t x, uint32_t y);
+
+static inline uint8_t qadd8(uint8_t i, uint8_t j) { return i + j > 255 ? 255 : i + j; }
+static inline uint8_t qsub8(uint8_t i, uint8_t j) { return i > j ? i - j : 0; }
+static inline uint8_t scale8(uint8_t i, uint8_t scale) { return ((uint16_t)i * (1 + scale)) >> 8; }
+static inline uint8_t scale8_video(uint8_t i, uint8_t scale)
+{
+    return (((uint16_t)i * scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+// 16-bit LCG, same sequence as FastLED's
+extern uint16_t rand16seed;
+static inline uint16_t random16()
+{
+    rand16seed = (rand16seed * 2053) + 13849;
+    return rand16seed;
+}
+static inline uint16_t random16(uint16_t lim) { return ((uint32_t)random16() * lim) >> 16; }
+static inline uint8_t random8()
+{
+    random16();
+    return (uint8_t)(rand16seed & 0xFF) + (uint8_t)(rand16seed >> 8);
+}
+static inline uint8_t random8(uint8_t lim) { return ((uint16_t)random8() * lim) >> 8; }
+static inline uint8_t random8(uint8_t min, uint8_t lim) { return min + random8(lim - min); }
+static inline void random16_add_entropy(uint16_t entropy) { rand16seed += entropy; }
+
+CRGB HeatColor(uint8_t temperature);
+
+class CLEDController
+{
+public:
+    virtual ~CLEDController() {}
+    virtual void init() = 0;
+    virtual void showColor(const CRGB &data, int nLeds, CRGB scale) = 0;
+    virtual void show(const CRGB *data, int nLeds, CRGB scale) = 0;
+};
+
+// Clockless chipsets all land here, the frame goes to the host (see NativeHal.h)
+class NativeLedController : public CLEDController
+{
+public:
+    void init() override {}
+    void showColor(const CRGB &data, int nLeds, CRGB scale) override;
+    void show(const CRGB *data, int nLeds, CRGB scale) override;
+};
+
+class CFastLED
+{
+public:
+    template <template <uint8_t, EOrder> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+    CLEDController &addLeds(CRGB *data, int nLeds)
+    {
+        static NativeLedController controller;
+        return addLeds(&controller, data, nLeds);
+    }
+    CLEDController &addLeds(CLEDController *controller, CRGB *data, int nLeds)
+    {
+        m_controller = controller;
+        m_data = data;
+        m_count = nLeds;
+        controller->init();
+        return *controller;
+    }
+
+    void setMaxPowerInVoltsAndMilliamps(uint8_t, uint32_t) {}
+    void setDither(uint8_t) {}
+    void setBrightness(uint8_t scale) { m_brightness = scale; }
+    uint8_t getBrightness() { return m_brightness; }
+    void show();
+    void delay(unsigned long ms);
+
+    CRGB *leds() { return m_data; }
+    int size() { return m_count; }
+
+private:
+    CLEDController *m_controller = nullptr;
+    CRGB *m_data = nullptr;
+    int m_count = 0;
+    uint8_t m_brightness = 255;
+};
+
+extern CFastLED FastLED;
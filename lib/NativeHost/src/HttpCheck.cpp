@@ -0,0 +1,302 @@
+#include <Arduino.h>
+#include <WiFiNINA.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HttpServer.h"
+#include "NativeHal.h"
+#include "SimClock.h"
+
+// HTTP server check
+//  Runs an HttpServer on simulated time against a client on a loopback
+//  socket, polling once per simulated millisecond as the scheduler would.
+//  Requests go in whole, a few bytes per poll or with a long pause, and
+//  the replies are checked for status line, headers and body. Covers the
+//  refusals, the timeout, a client that hangs up, and that POST /settings
+//  sets every field or none of them.
+//
+//  program http [--port P]
+
+const uint16_t HTTP_CHECK_PORT = 8081;                     // Beside the sketch's own server
+const uint32_t HTTP_CHECK_START_MS = 1000;                 // millis() when the check starts
+const uint32_t HTTP_CHECK_WAIT_MS = HTTP_TIMEOUT_MS + 100; // Longest one exchange is followed
+const uint16_t HTTP_CHECK_REPLY_MAX = HTTP_HEADER_MAX + HTTP_RESPONSE_MAX;
+
+// The sketch's handler and some of the parameters it sets
+uint16_t httpRequest(HttpRequest &request, Print &body);
+extern uint8_t anim_speed;
+extern uint8_t effect_hue;
+extern char tz_rule[];
+
+static uint16_t httpPort = HTTP_CHECK_PORT;
+static uint32_t httpFailures = 0;
+
+struct HttpReply
+{
+    char text[HTTP_CHECK_REPLY_MAX + 1]; // Status line, headers and body
+    uint16_t length;
+    uint16_t status;    // 0 when nothing came back
+    const char *body;
+    bool closed;        // The server hung up
+    uint32_t closed_ms; // Time from connecting to the hang up
+};
+
+static void check(bool ok, const char *what)
+{
+    printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+    httpFailures += ok ? 0 : 1;
+}
+
+// /echo answers with the method, path and body, /settings goes to the
+// sketch, anything else is not found
+static uint16_t checkHandler(HttpRequest &request, Print &body)
+{
+    if (strcmp(request.path, "/echo") == 0)
+    {
+        body.print(request.method == HTTP_GET ? "GET " : request.method == HTTP_POST ? "POST " : "OTHER ");
+        body.print(request.path);
+        body.print(' ');
+        body.print(request.method == HTTP_POST ? request.body : "");
+        return 200;
+    }
+    if (strcmp(request.path, "/settings") == 0)
+    {
+        return httpRequest(request, body);
+    }
+    return 404;
+}
+
+static int connectClient()
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(httpPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd >= 0 && connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// Take what has arrived, note when the server hangs up
+static void receive(int fd, HttpReply &reply, uint32_t start_ms)
+{
+    while (!reply.closed)
+    {
+        char *end = reply.text + reply.length;
+        ssize_t count = recv(fd, end, HTTP_CHECK_REPLY_MAX - reply.length, MSG_DONTWAIT);
+        if (count > 0)
+        {
+            reply.length += count;
+            continue;
+        }
+        if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            reply.closed = true;
+            reply.closed_ms = millis() - start_ms;
+        }
+        break;
+    }
+}
+
+// One request on a new connection
+//  Sends chunk bytes per poll, waits pause_ms after the first chunk, and
+//  hangs up after the last one when asked to. Then polls until the server
+//  closes the connection, or drops it after the hang up, or
+//  HTTP_CHECK_WAIT_MS have gone by.
+static void exchange(HttpServer &server, const char *request, size_t chunk, uint32_t pause_ms, bool hang_up,
+                     HttpReply &reply)
+{
+    memset(&reply, 0, sizeof(reply));
+    int fd = connectClient();
+    if (fd < 0)
+    {
+        return;
+    }
+    uint32_t start_ms = millis();
+    uint32_t finished = server.served() + server.dropped();
+    size_t length = strlen(request);
+    size_t sent = 0;
+    bool first = true;
+    while (!reply.closed && millis() - start_ms < HTTP_CHECK_WAIT_MS)
+    {
+        if (sent < length && (first || millis() - start_ms >= pause_ms))
+        {
+            size_t part = length - sent < chunk ? length - sent : chunk;
+            send(fd, request + sent, part, MSG_NOSIGNAL);
+            sent += part;
+            first = false;
+            if (sent == length && hang_up)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+        server.poll();
+        if (fd >= 0)
+        {
+            receive(fd, reply, start_ms);
+        }
+        else if (server.served() + server.dropped() != finished)
+        {
+            reply.closed = true;
+            reply.closed_ms = millis() - start_ms;
+        }
+        simClockAdvance(1000);
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    reply.text[reply.length] = '\0';
+    if (strncmp(reply.text, "HTTP/1.0 ", 9) == 0)
+    {
+        reply.status = atoi(reply.text + 9);
+    }
+    const char *blank = strstr(reply.text, "\r\n\r\n");
+    reply.body = blank ? blank + 4 : reply.text + reply.length;
+}
+
+// Status line version, Connection: close and a Content-Length that matches
+static bool wellFormed(const HttpReply &reply)
+{
+    const char *length = strstr(reply.text, "\r\nContent-Length: ");
+    return reply.status && reply.closed && strstr(reply.text, "\r\nConnection: close\r\n") && length &&
+           (size_t)atoi(length + 18) == strlen(reply.body);
+}
+
+static void checkRequest(HttpServer &server, const char *name, const char *request, size_t chunk,
+                         uint16_t status, const char *body = nullptr, uint32_t pause_ms = 0)
+{
+    HttpReply reply;
+    exchange(server, request, chunk, pause_ms, false, reply);
+    char line[96];
+    snprintf(line, sizeof(line), "%s: %u in %u ms", name, reply.status, reply.closed_ms);
+    check(wellFormed(reply) && reply.status == status && (!body || strcmp(reply.body, body) == 0), line);
+}
+
+static void post(HttpServer &server, const char *form, HttpReply &reply)
+{
+    char request[HTTP_LINE_MAX + HTTP_BODY_MAX];
+    snprintf(request, sizeof(request), "POST /settings HTTP/1.0\r\nContent-Length: %u\r\n\r\n%s",
+             (unsigned)strlen(form), form);
+    exchange(server, request, SIZE_MAX, 0, false, reply);
+}
+
+// A refused form leaves every parameter as it was, a good one sets them all
+static void checkSettings(HttpServer &server, const char *form, uint16_t status, uint8_t speed, uint8_t hue,
+                          const char *rule)
+{
+    HttpReply reply;
+    post(server, form, reply);
+    char line[96];
+    snprintf(line, sizeof(line), "POST %.32s: %u, anim_speed %u, hue %u", form, reply.status, anim_speed,
+             effect_hue);
+    check(wellFormed(reply) && reply.status == status && anim_speed == speed && effect_hue == hue &&
+              strcmp(tz_rule, rule) == 0,
+          line);
+}
+
+int runHttpCheck(int argc, char **argv)
+{
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--port") == 0)
+        {
+            httpPort = strtoul(argv[i + 1], nullptr, 0);
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    WiFiServer listener(httpPort);
+    HttpServer server(listener, checkHandler);
+    server.begin();
+    int probe = connectClient();
+    if (probe < 0)
+    {
+        fprintf(stderr, "Cannot listen on port %u\n", httpPort);
+        return 2;
+    }
+    close(probe);
+    simClockStart((uint64_t)HTTP_CHECK_START_MS * 1000);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        server.poll(); // Let the probe go
+        simClockAdvance(1000);
+    }
+    uint32_t dropped = server.dropped();
+
+    const char *get = "GET /echo?x=1 HTTP/1.0\r\nHost: clock\r\nAccept: */*\r\n\r\n";
+    const char *form = "POST /echo HTTP/1.0\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                       "Content-Length: 21\r\n\r\nanim_speed=7&hue=1%2B";
+    checkRequest(server, "GET in one piece", get, SIZE_MAX, 200, "GET /echo ");
+    checkRequest(server, "GET a byte per poll", get, 1, 200, "GET /echo ");
+    checkRequest(server, "POST a byte per poll", form, 1, 200, "POST /echo anim_speed=7&hue=1%2B");
+    checkRequest(server, "POST in one piece", form, SIZE_MAX, 200, "POST /echo anim_speed=7&hue=1%2B");
+    checkRequest(server, "POST with the body 2.9 s late", form, strlen(form) - 5, 200,
+                 "POST /echo anim_speed=7&hue=1%2B", HTTP_TIMEOUT_MS - 100);
+
+    char line[HTTP_LINE_MAX * 2];
+    snprintf(line, sizeof(line), "GET /%0*d HTTP/1.0\r\n\r\n", HTTP_LINE_MAX, 0);
+    checkRequest(server, "request line over HTTP_LINE_MAX", line, 16, 414);
+    snprintf(line, sizeof(line), "GET /%0*d HTTP/1.0\r\n\r\n", HTTP_PATH_MAX, 0);
+    checkRequest(server, "path over HTTP_PATH_MAX", line, SIZE_MAX, 414);
+    snprintf(line, sizeof(line), "GET /echo HTTP/1.0\r\nCookie: %0*d\r\n\r\n", HTTP_LINE_MAX, 0);
+    checkRequest(server, "long header line skipped", line, 16, 200, "GET /echo ");
+    checkRequest(server, "no path", "HELLO\r\n\r\n", SIZE_MAX, 400);
+    checkRequest(server, "unknown path", "GET /missing HTTP/1.0\r\n\r\n", SIZE_MAX, 404);
+    checkRequest(server, "body over HTTP_BODY_MAX", "POST /echo HTTP/1.0\r\nContent-Length: 1000\r\n\r\n",
+                 SIZE_MAX, 413);
+    checkRequest(server, "PUT /settings", "PUT /settings HTTP/1.0\r\n\r\n", SIZE_MAX, 405);
+
+    HttpReply reply;
+    exchange(server, "GET /echo HTTP/1.0\r\nHost: clo", SIZE_MAX, 0, false, reply);
+    snprintf(line, sizeof(line), "request that stops: dropped after %u ms", reply.closed_ms);
+    check(reply.closed && !reply.length && reply.closed_ms >= HTTP_TIMEOUT_MS &&
+              reply.closed_ms <= HTTP_TIMEOUT_MS + 1 && server.dropped() == dropped + 1,
+          line);
+    exchange(server, "POST /echo HTTP/1.0\r\nContent-Length: 20\r\n\r\nanim", SIZE_MAX, 0, true, reply);
+    snprintf(line, sizeof(line), "client hangs up part way through the body: dropped in %u ms", reply.closed_ms);
+    check(reply.closed && server.dropped() == dropped + 2, line);
+    checkRequest(server, "next request served", get, SIZE_MAX, 200, "GET /echo ");
+
+    char rule[48];
+    strcpy(rule, tz_rule);
+    uint8_t speed = anim_speed;
+    uint8_t hue = effect_hue;
+    checkSettings(server, "anim_speed=9&hue=300", 400, speed, hue, rule);
+    checkSettings(server, "anim_speed=9&colour=3", 400, speed, hue, rule);
+    checkSettings(server, "anim_speed=9&brightness=3", 400, speed, hue, rule);
+    checkSettings(server, "anim_speed=9&hue=40&tz=CET-1CEST,M3.5.0,M10.5.0%2F3", 200, 9, 40,
+                  "CET-1CEST,M3.5.0,M10.5.0/3");
+    checkSettings(server, "hue=50&tz=not+a+rule&anim_speed=10", 400, 9, 40, "CET-1CEST,M3.5.0,M10.5.0/3");
+    checkSettings(server, "anim_speed=11&tz=EST5EDT,M3.2.0,M11.1.0&ntp_server=", 400, 9, 40,
+                  "CET-1CEST,M3.5.0,M10.5.0/3");
+    checkSettings(server, "tz=EST5EDT,M3.2.0,M11.1.0&anim_speed=10&anim_speed=12", 200, 12, 40,
+                  "EST5EDT,M3.2.0,M11.1.0");
+    post(server, "hue=1&effect=99", reply);
+    snprintf(line, sizeof(line), "refusal names the parameter: %.40s", reply.body);
+    check(reply.status == 400 && strstr(reply.body, "\"parameter\":\"effect\""), line);
+
+    simClockStop();
+    printf("%u served, %u dropped\n", server.served(), server.dropped() - dropped);
+    if (httpFailures)
+    {
+        printf("%u check(s) failed\n", httpFailures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+// IPv4 address, stored in network byte order like the Arduino core
+class IPAddress
+{
+public:
+    IPAddress() : m_addr(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : m_addr((uint32_t)a | (uint32_t)b << 8 | (uint32_t)c << 16 | (uint32_t)d << 24) {}
+    IPAddress(uint32_t addr) : m_addr(addr) {}
+
+    operator uint32_t() const { return m_addr; }
+    uint8_t operator[](int i) const { return (m_addr >> (8 * i)) & 0xFF; }
+    bool operator==(const IPAddress &other) const { return m_addr == other.m_addr; }
+
+private:
+    uint32_t m_addr;
+};
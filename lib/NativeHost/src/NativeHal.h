@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Host side controls for the native stand-ins
+//  The sketch never includes this, the benchmark suite and host tools use it
+//  to feed inputs and look at outputs.
+
+// Time
+//  millis(), micros(), delay() and the RTC all run off one clock source,
+//  the host's steady clock unless another one is set (see SimClock.h)
+struct HalClock
+{
+    uint64_t (*micros)();       // Microseconds since start
+    void (*sleep)(uint64_t us); // Used by delay()
+};
+void halSetClock(const HalClock *clock); // nullptr for the host clock
+uint64_t halMicros64();
+
+// Inputs
+void halSetAnalog(uint8_t pin, int value); // Value returned by analogRead(pin), 0..1023
+void halSetWiFiStatus(int status);        // Value returned by WiFi.status()
+void halSetSerialMuted(bool muted);       // Drop Serial output
+
+// LED output
+//  FastLED.show() hands the scaled frame to the host
+uint32_t halShowCount();   // Frames shown since start
+const CRGB *halLedFrame(); // Last frame shown, brightness applied
+uint16_t halLedCount();    // LEDs in the last frame
+
+// Settings flash
+//  The NvmFlash region lives in RAM, erased at start
+void halFlashReset();                  // Erase everything and clear the counters
+void halFlashCutAfter(int32_t bytes);  // Fail writes and erases once this many more bytes are written, -1 for never
+uint32_t halFlashErases(uint32_t row); // Times a row was erased
+uint32_t halFlashOverwrites();         // Words written that were not erased, always a store bug
+
+// Frame benchmark suite, run by "program bench [options]"
+//  Returns the process exit code, nonzero when a stage regressed
+int runBenchmarks(int argc, char **argv);
+
+// Time-warp replay, run by "program replay [options]"
+//  Returns the process exit code, nonzero when the clock disagreed with the host
+int runReplay(int argc, char **argv);
+
+// Settings store check, run by "program store [options]"
+//  Returns the process exit code, nonzero when a value was lost
+int runStoreCheck(int argc, char **argv);
+
+// SNTP client check, run by "program ntp [options]"
+//  Returns the process exit code, nonzero when a check failed
+int runNtpCheck(int argc, char **argv);
+
+// Drift estimator check, run by "program drift [options]"
+//  Returns the process exit code, nonzero when a check failed
+int runDriftCheck(int argc, char **argv);
+
+// HTTP server check, run by "program http [options]"
+//  Returns the process exit code, nonzero when a check failed
+int runHttpCheck(int argc, char **argv);
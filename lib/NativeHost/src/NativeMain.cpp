@@ -0,0 +1,46 @@
+#include <Arduino.h>
+
+#include "NativeHal.h"
+
+// Entry point of the native build
+//  program             run the sketch, setup() then loop() forever
+//  program bench ...   run the frame benchmark suite (see Benchmark.cpp)
+//  program replay ...  step the sketch through a year (see Replay.cpp)
+//  program store ...   check the settings store on the RAM flash (see StoreCheck.cpp)
+//  program ntp ...     check the SNTP client against a simulated server (see NtpCheck.cpp)
+//  program drift ...   check the drift estimate and FREQCORR mapping (see DriftCheck.cpp)
+//  program http ...    check the HTTP server over a loopback socket (see HttpCheck.cpp)
+int main(int argc, char **argv)
+{
+    setvbuf(stdout, nullptr, _IOLBF, 0); // Serial lines show up as they are printed
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        return runBenchmarks(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "replay") == 0)
+    {
+        return runReplay(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "store") == 0)
+    {
+        return runStoreCheck(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "ntp") == 0)
+    {
+        return runNtpCheck(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "drift") == 0)
+    {
+        return runDriftCheck(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "http") == 0)
+    {
+        return runHttpCheck(argc - 2, argv + 2);
+    }
+
+    setup();
+    for (;;)
+    {
+        loop();
+    }
+}
@@ -0,0 +1,337 @@
+#include <Arduino.h>
+
+#include <stdlib.h>
+
+#include "NativeHal.h"
+#include "NtpClient.h"
+#include "SimClock.h"
+
+// SNTP client check
+//  Runs an NtpClient on simulated time against an in-process server behind
+//  a UDP stand-in, with set delays each way and a set hold time at the
+//  server. Checks the half round trip correction, that bad replies are
+//  refused, the timeout, the backoff sequence and that an outage does not
+//  bring back a DNS lookup on every retry.
+//
+//  program ntp [--delay MS]
+
+const uint32_t NTP_CHECK_DELAY_MS = 40;           // One way network delay
+const uint32_t NTP_CHECK_HOLD_MS = 7;             // Time the server holds a request
+const uint32_t NTP_CHECK_START_MS = 1000;         // millis() when the check starts
+const uint64_t NTP_CHECK_SERVER_MS = 1700000000123ULL; // Server time at the start, ms since 1970
+const uint32_t NTP_CHECK_UNIX_OFFSET = 2208988800UL;
+const IPAddress NTP_CHECK_IP(192, 0, 2, 123);
+
+enum ntp_check_reply_t
+{
+    REPLY_GOOD,
+    REPLY_NONE,       // Server down
+    REPLY_BAD_ORIGIN, // Origin timestamp does not echo the request
+    REPLY_UNSYNCED,   // Stratum 0
+    REPLY_STRANGER    // Good reply from another address
+};
+
+static void writeBE32(uint8_t *p, uint32_t value)
+{
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+// NTP timestamp for a time in ms, the fraction rounded up so it reads back
+// as the same millisecond
+static void writeTimestamp(uint8_t *p, uint64_t ms)
+{
+    writeBE32(p, (uint32_t)(ms / 1000 + NTP_CHECK_UNIX_OFFSET));
+    writeBE32(p + 4, (uint32_t)((((uint64_t)(ms % 1000) << 32) + 999) / 1000));
+}
+
+// UDP with the server on the other end
+//  A request is answered when it would reach the server, and the reply
+//  shows up in parsePacket() once it would be back.
+class CheckUdp : public UDP
+{
+public:
+    ntp_check_reply_t reply = REPLY_GOOD;
+    uint32_t out_ms = NTP_CHECK_DELAY_MS;  // Delay to the server
+    uint32_t back_ms = NTP_CHECK_DELAY_MS; // Delay from the server
+    uint32_t requests = 0;
+    uint32_t last_request_ms = 0;
+
+    uint8_t begin(uint16_t) override { return 1; }
+    void stop() override {}
+
+    int beginPacket(IPAddress ip, uint16_t port) override
+    {
+        m_tx_len = 0;
+        return ip == NTP_CHECK_IP && port == 123;
+    }
+    int beginPacket(const char *, uint16_t) override { return 0; } // The client looks up names itself
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        size = size < sizeof(m_tx) - m_tx_len ? size : sizeof(m_tx) - m_tx_len;
+        memcpy(m_tx + m_tx_len, buffer, size);
+        m_tx_len += size;
+        return size;
+    }
+    int endPacket() override
+    {
+        requests++;
+        last_request_ms = millis();
+        if (reply != REPLY_NONE && m_tx_len == NTP_PACKET_SIZE)
+        {
+            answer();
+        }
+        return 1;
+    }
+
+    int parsePacket() override
+    {
+        m_rx_pos = 0;
+        if (!m_pending || (int32_t)(millis() - m_due_ms) < 0)
+        {
+            m_rx_len = 0;
+            return 0;
+        }
+        m_pending = false;
+        m_rx_len = NTP_PACKET_SIZE;
+        return m_rx_len;
+    }
+    int available() override { return m_rx_len - m_rx_pos; }
+    int read() override { return m_rx_pos < m_rx_len ? m_rx[m_rx_pos++] : -1; }
+    int read(unsigned char *buffer, size_t len) override
+    {
+        int count = 0;
+        while ((size_t)count < len && m_rx_pos < m_rx_len)
+        {
+            buffer[count++] = m_rx[m_rx_pos++];
+        }
+        return count;
+    }
+    int read(char *buffer, size_t len) override { return read((unsigned char *)buffer, len); }
+    int peek() override { return m_rx_pos < m_rx_len ? m_rx[m_rx_pos] : -1; }
+    void flush() override {}
+
+    IPAddress remoteIP() override { return reply == REPLY_STRANGER ? IPAddress(192, 0, 2, 66) : NTP_CHECK_IP; }
+    uint16_t remotePort() override { return 123; }
+
+    // Server time for a millis() value
+    static uint64_t serverMs(uint32_t ms) { return NTP_CHECK_SERVER_MS + ms; }
+
+private:
+    void answer()
+    {
+        uint32_t arrive_ms = millis() + out_ms;
+        memset(m_rx, 0, sizeof(m_rx));
+        m_rx[0] = 0b00100100; // LI 0, version 4, mode 4 (server)
+        m_rx[1] = reply == REPLY_UNSYNCED ? 0 : 2;
+        memcpy(m_rx + 24, m_tx + 40, 8);
+        if (reply == REPLY_BAD_ORIGIN)
+        {
+            m_rx[31] ^= 1;
+        }
+        writeTimestamp(m_rx + 32, serverMs(arrive_ms));
+        writeTimestamp(m_rx + 40, serverMs(arrive_ms + NTP_CHECK_HOLD_MS));
+        m_due_ms = arrive_ms + NTP_CHECK_HOLD_MS + back_ms;
+        m_pending = true;
+    }
+
+    uint8_t m_tx[NTP_PACKET_SIZE];
+    size_t m_tx_len = 0;
+    uint8_t m_rx[NTP_PACKET_SIZE];
+    int m_rx_len = 0;
+    int m_rx_pos = 0;
+    bool m_pending = false;
+    uint32_t m_due_ms = 0;
+};
+
+static bool checkDnsUp = true;
+
+static int checkResolve(const char *host, IPAddress &ip)
+{
+    if (!checkDnsUp || strcmp(host, "ntp.test") != 0)
+    {
+        return 0;
+    }
+    ip = NTP_CHECK_IP;
+    return 1;
+}
+
+static uint32_t checkFailures = 0;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-52s %s\n", what, ok ? "ok" : "FAILED");
+    checkFailures += ok ? 0 : 1;
+}
+
+// Poll once per simulated millisecond until a result, or limit_ms passes
+static bool runQuery(NtpClient &ntp, uint32_t limit_ms)
+{
+    ntp.request();
+    for (uint32_t i = 0; i < limit_ms; i++)
+    {
+        if (ntp.poll())
+        {
+            return true;
+        }
+        simClockAdvance(1000);
+    }
+    return false;
+}
+
+// Poll until the client sends its next request
+static uint32_t nextRequest(NtpClient &ntp, CheckUdp &udp, uint32_t limit_ms)
+{
+    uint32_t requests = udp.requests;
+    uint32_t start = millis();
+    while (udp.requests == requests && millis() - start < limit_ms)
+    {
+        ntp.request();
+        ntp.poll();
+        simClockAdvance(1000);
+    }
+    return udp.last_request_ms;
+}
+
+// Error of a result against the server clock at the moment it arrived, ms
+static int32_t resultError(const NtpResult &result)
+{
+    uint64_t ms = (uint64_t)result.utc * 1000 + result.utc_ms;
+    return (int32_t)(ms - CheckUdp::serverMs(result.received_ms));
+}
+
+int runNtpCheck(int argc, char **argv)
+{
+    uint32_t delay_ms = NTP_CHECK_DELAY_MS;
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--delay") == 0)
+        {
+            delay_ms = strtoul(argv[i + 1], nullptr, 0);
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (delay_ms * 2 + NTP_CHECK_HOLD_MS >= NTP_TIMEOUT_MS)
+    {
+        fprintf(stderr, "Delay leaves no time for a reply\n");
+        return 2;
+    }
+
+    simClockStart((uint64_t)NTP_CHECK_START_MS * 1000);
+    CheckUdp udp;
+    NtpClient ntp(udp, checkResolve);
+    ntp.begin("ntp.test");
+    udp.out_ms = delay_ms;
+    udp.back_ms = delay_ms;
+    char line[80];
+
+    // Symmetric path, the half round trip makes up the whole return delay
+    bool done = runQuery(ntp, NTP_TIMEOUT_MS);
+    const NtpResult &result = ntp.result();
+    snprintf(line, sizeof(line), "symmetric %u ms each way: error %d ms, delay %u ms", delay_ms,
+             resultError(result), result.delay_ms);
+    check(done && resultError(result) == 0 && result.delay_ms == delay_ms * 2, line);
+
+    // Asymmetric path, off by half the difference as SNTP has to be
+    udp.out_ms = delay_ms / 2;
+    udp.back_ms = delay_ms * 3 / 2;
+    done = runQuery(ntp, NTP_TIMEOUT_MS);
+    snprintf(line, sizeof(line), "asymmetric %u/%u ms: error %d ms", udp.out_ms, udp.back_ms, resultError(result));
+    check(done && resultError(result) == (int32_t)((udp.out_ms + udp.back_ms) / 2) - (int32_t)udp.back_ms, line);
+    udp.out_ms = delay_ms;
+    udp.back_ms = delay_ms;
+
+    // Replies that must be refused, each runs into the timeout
+    const ntp_check_reply_t bad[] = {REPLY_BAD_ORIGIN, REPLY_UNSYNCED, REPLY_STRANGER, REPLY_NONE};
+    const char *bad_names[] = {"wrong origin timestamp", "unsynchronised server", "reply from another address",
+                               "no reply"};
+    for (uint8_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        udp.reply = bad[i];
+        uint32_t failures = ntp.failures();
+        uint32_t sent = nextRequest(ntp, udp, NTP_BACKOFF_MAX_MS * 2);
+        uint32_t timed_out = 0;
+        while (ntp.failures() == failures && millis() - sent < NTP_TIMEOUT_MS * 2)
+        {
+            ntp.poll();
+            timed_out = millis() - sent;
+            simClockAdvance(1000);
+        }
+        snprintf(line, sizeof(line), "%s: refused, failed after %u ms", bad_names[i], timed_out);
+        check(ntp.failures() == failures + 1 && timed_out == NTP_TIMEOUT_MS && ntp.state() == NTP_BACKOFF, line);
+    }
+
+    // Backoff doubles between retries up to the ceiling with the server down.
+    // The address is kept, and looked up again only every NTP_RESOLVE_MS.
+    udp.reply = REPLY_NONE;
+    checkDnsUp = false;
+    uint32_t lookups = ntp.lookups();
+    uint32_t lookup_ms = NTP_CHECK_START_MS; // The first lookup, at the first query
+    uint32_t gap_min = UINT32_MAX;
+    uint32_t gap_max = 0;
+    uint32_t sent = nextRequest(ntp, udp, NTP_BACKOFF_MAX_MS * 2);
+    uint32_t expected = ntp.backoff();
+    bool doubling = true;
+    uint32_t retries = 0;
+    uint32_t outage_start = sent;
+    while (millis() - outage_start < NTP_RESOLVE_MS * 3)
+    {
+        uint32_t before = ntp.lookups();
+        uint32_t next = nextRequest(ntp, udp, NTP_BACKOFF_MAX_MS * 2);
+        // The retry goes out on the poll after the backoff ends
+        if (next - sent != NTP_TIMEOUT_MS + expected + 1)
+        {
+            doubling = false;
+        }
+        expected = expected * 2 > NTP_BACKOFF_MAX_MS ? NTP_BACKOFF_MAX_MS : expected * 2;
+        if (ntp.lookups() != before)
+        {
+            gap_min = next - lookup_ms < gap_min ? next - lookup_ms : gap_min;
+            gap_max = next - lookup_ms > gap_max ? next - lookup_ms : gap_max;
+            lookup_ms = next;
+        }
+        sent = next;
+        retries++;
+    }
+    snprintf(line, sizeof(line), "backoff over %u retries, ceiling %u ms", retries, ntp.backoff());
+    check(doubling && ntp.backoff() == NTP_BACKOFF_MAX_MS, line);
+    snprintf(line, sizeof(line), "outage: %u lookups, %u to %u s apart", ntp.lookups() - lookups, gap_min / 1000,
+             gap_max / 1000);
+    check(ntp.lookups() - lookups >= 2 && gap_min >= NTP_RESOLVE_MS &&
+              gap_max <= NTP_RESOLVE_MS + NTP_TIMEOUT_MS + NTP_BACKOFF_MAX_MS,
+          line);
+    check((uint32_t)ntp.serverIP() == (uint32_t)NTP_CHECK_IP, "failed lookup keeps the last address");
+
+    // Recovery resets the backoff
+    udp.reply = REPLY_GOOD;
+    checkDnsUp = true;
+    done = false;
+    for (uint32_t i = 0; i < NTP_BACKOFF_MAX_MS + NTP_TIMEOUT_MS * 2 && !done; i++)
+    {
+        done = ntp.poll();
+        simClockAdvance(1000);
+    }
+    snprintf(line, sizeof(line), "recovery: error %d ms, backoff %u ms", resultError(result), ntp.backoff());
+    check(done && resultError(result) == 0 && ntp.backoff() == NTP_BACKOFF_MIN_MS, line);
+
+    // A new server is looked up on the next query
+    lookups = ntp.lookups();
+    ntp.begin("ntp.test");
+    done = runQuery(ntp, NTP_TIMEOUT_MS);
+    check(done && ntp.lookups() == lookups + 1, "new server looked up once");
+
+    simClockStop();
+    if (checkFailures)
+    {
+        printf("%u check(s) failed\n", checkFailures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "NvmFlash.h"
+
+#include "NativeHal.h"
+
+// The flash region in RAM
+//  Programming ANDs into what is there, like the real cells. The host can
+//  cut the power part way through a write (see NativeHal.h).
+struct FlashModel
+{
+    uint8_t data[NVM_FLASH_SIZE];
+    uint32_t erases[NVM_FLASH_SIZE / NVM_FLASH_ROW];
+    uint32_t overwrites;
+    int32_t budget; // Bytes left before the power goes, -1 for no cut
+    FlashModel() { reset(); }
+    void reset()
+    {
+        memset(data, 0xFF, sizeof(data));
+        memset(erases, 0, sizeof(erases));
+        overwrites = 0;
+        budget = -1;
+    }
+};
+static FlashModel flashModel;
+
+bool NvmFlash::begin()
+{
+    return true;
+}
+
+void NvmFlash::read(uint32_t addr, void *buf, uint32_t len)
+{
+    memcpy(buf, flashModel.data + addr, len);
+}
+
+bool NvmFlash::erase(uint32_t addr)
+{
+    if (addr >= NVM_FLASH_SIZE || flashModel.budget == 0)
+    {
+        return false;
+    }
+    uint32_t row = addr / NVM_FLASH_ROW;
+    memset(flashModel.data + row * NVM_FLASH_ROW, 0xFF, NVM_FLASH_ROW);
+    flashModel.erases[row]++;
+    return true;
+}
+
+bool NvmFlash::write(uint32_t addr, const void *data, uint32_t len)
+{
+    if ((addr | len) & 3 || addr + len > NVM_FLASH_SIZE)
+    {
+        return false;
+    }
+    const uint8_t *src = (const uint8_t *)data;
+    for (uint32_t i = 0; i < len; i += 4)
+    {
+        if (flashModel.budget == 0)
+        {
+            return false;
+        }
+        uint8_t *word = flashModel.data + addr + i;
+        uint32_t erased = word[0] & word[1] & word[2] & word[3];
+        if (erased != 0xFF)
+        {
+            flashModel.overwrites++;
+        }
+        for (uint8_t b = 0; b < 4; b++)
+        {
+            word[b] &= src[i + b];
+        }
+        if (flashModel.budget > 0)
+        {
+            flashModel.budget -= flashModel.budget < 4 ? flashModel.budget : 4;
+        }
+    }
+    return true;
+}
+
+void halFlashReset()
+{
+    flashModel.reset();
+}
+
+void halFlashCutAfter(int32_t bytes)
+{
+    flashModel.budget = bytes;
+}
+
+uint32_t halFlashErases(uint32_t row)
+{
+    return row < NVM_FLASH_SIZE / NVM_FLASH_ROW ? flashModel.erases[row] : 0;
+}
+
+uint32_t halFlashOverwrites()
+{
+    return flashModel.overwrites;
+}
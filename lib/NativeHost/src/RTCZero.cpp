@@ -0,0 +1,63 @@
+#include <RTCZero.h>
+
+#include <time.h>
+
+#include "NativeHal.h"
+
+void RTCZero::begin(bool resetTime)
+{
+    if (resetTime)
+    {
+        setEpoch(946684800);
+    }
+}
+
+void RTCZero::setEpoch(uint32_t epoch)
+{
+    m_epoch = epoch;
+    m_set_us = halMicros64();
+}
+
+uint32_t RTCZero::getEpoch()
+{
+    return m_epoch + (uint32_t)((halMicros64() - m_set_us) / 1000000);
+}
+
+// Calendar fields, broken down by the host C library
+static struct tm rtcTime(RTCZero &rtc)
+{
+    time_t epoch = rtc.getEpoch();
+    struct tm fields;
+    gmtime_r(&epoch, &fields);
+    return fields;
+}
+
+uint8_t RTCZero::getSeconds()
+{
+    return rtcTime(*this).tm_sec;
+}
+
+uint8_t RTCZero::getMinutes()
+{
+    return rtcTime(*this).tm_min;
+}
+
+uint8_t RTCZero::getHours()
+{
+    return rtcTime(*this).tm_hour;
+}
+
+uint8_t RTCZero::getDay()
+{
+    return rtcTime(*this).tm_mday;
+}
+
+uint8_t RTCZero::getMonth()
+{
+    return rtcTime(*this).tm_mon + 1;
+}
+
+uint8_t RTCZero::getYear()
+{
+    return rtcTime(*this).tm_year - 100;
+}
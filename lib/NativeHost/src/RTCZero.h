@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+
+// RTCZero stand-in for the native build
+//  Counts whole seconds on the host clock, starting at 2000-01-01 like the SAMD RTC
+class RTCZero
+{
+public:
+    void begin(bool resetTime = false);
+
+    void setEpoch(uint32_t epoch);
+    uint32_t getEpoch();
+
+    uint8_t getSeconds();
+    uint8_t getMinutes();
+    uint8_t getHours();
+    uint8_t getDay();
+    uint8_t getMonth();
+    uint8_t getYear();
+
+private:
+    uint32_t m_epoch = 946684800; // 2000-01-01 00:00:00 UTC
+    uint64_t m_set_us = 0;        // Host microseconds when m_epoch was set
+};
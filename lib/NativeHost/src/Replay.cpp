@@ -0,0 +1,357 @@
+#include <Arduino.h>
+#include <RTCZero.h>
+#include <WiFiNINA.h>
+
+#include <chrono>
+#include <stdlib.h>
+#include <time.h>
+
+#include "NativeHal.h"
+#include "Scheduler.h"
+#include "SimClock.h"
+#include "TimeSnapshot.h"
+#include "TimeZone.h"
+#include "WordLayer.h"
+#include "WordMask.h"
+
+// Time-warp replay
+//  Runs the sketch's scheduler on a simulated clock through a whole year, one
+//  step per minute. At every step the DST flag and the lit words are checked
+//  against the host C library's idea of local time for the same TZ rule, and
+//  optionally written out as CSV.
+//  By default the clock jumps from step to step and each step runs every
+//  due task once, one frame among them. The host CPU per day is then an
+//  estimate, the mean cost of a step times the frames a day holds at the
+//  render period. With --full the clock moves one scheduler tick (1 ms)
+//  at a time between the steps and every due task runs at its own
+//  cadence, so the CPU per simulated day is measured and overruns are
+//  counted. That takes tens of seconds of host time per day, use it
+//  with --days.
+//
+//  program replay [--year Y] [--days N] [--tz RULE] [--step S] [--full] [--millis-start MS] [--out FILE]
+//
+//  The simulated millis() starts shortly before it wraps, and micros() wraps
+//  every 71 minutes, so both wraps are crossed on every run.
+
+// Sketch state, from src/main.cpp
+extern RTCZero rtc;
+extern Scheduler scheduler;
+extern TimeZone tz;
+extern TimeSnapshot timeNow;
+extern WordLayer wordLayer;
+
+const uint16_t REPLAY_YEAR = 2024;
+const char REPLAY_TZ_RULE[] = "EST5EDT,M3.2.0,M11.1.0";
+const uint32_t REPLAY_STEP_S = 60; // Simulated seconds per step
+const uint64_t REPLAY_MILLIS_START = 0x100000000ULL - 10 * 60000; // millis() wraps 10 minutes in
+const uint8_t REPLAY_MAX_RUNS = 16; // Scheduler passes per step
+const uint8_t REPLAY_MAX_REPORTS = 10; // Mismatches printed in full
+const uint32_t REPLAY_TICK_MS = 1;     // Scheduler tick with --full
+
+// Reference phrase
+//  Written out apart from the face tables the sketch renders from: the
+//  English phrase for each hour and 5 minute slot, as the original sketch
+//  built it, and its hand-written LED wiring. The lit LEDs, read in
+//  reading order off the face letters, have to spell the phrase.
+static const char *const referenceMinutes[12] = {
+    "",       "FIVE PAST", "TEN PAST", "A QUARTER PAST", "TWENTY PAST", "TWENTY FIVE PAST",
+    "HALF PAST", "TWENTY FIVE TO", "TWENTY TO", "A QUARTER TO", "TEN TO", "FIVE TO"};
+static const char *const referenceHours[12] = {"TWELVE", "ONE", "TWO",   "THREE",  "FOUR",   "FIVE",
+                                               "SIX",    "SEVEN", "EIGHT", "NINE", "TEN", "ELEVEN"};
+static const uint8_t referenceWiring[10][12] = {
+    {119, 118, 117, 116, 115, 114, 113, 112, 111, 110, 109, 108},
+    {96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107},
+    {95, 94, 93, 92, 91, 90, 89, 88, 87, 86, 85, 84},
+    {72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83},
+    {71, 70, 69, 68, 67, 66, 65, 64, 63, 62, 61, 60},
+    {48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59},
+    {47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36},
+    {24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35},
+    {23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}};
+
+// The reference covers the English face only
+static bool referenceFace()
+{
+    return WC_X == 12 && WC_Y == 10 && strcmp(Face::letters[0], "ITTISIMHALFE") == 0;
+}
+
+// Phrase for a local time with the spaces left out, "ITISTENPASTFOUR"
+static void referencePhrase(uint8_t hour, uint8_t minute, char *text)
+{
+    uint8_t slot = minute / 5;
+    char phrase[48];
+    snprintf(phrase, sizeof(phrase), "IT IS %s %s%s", referenceMinutes[slot],
+             referenceHours[(hour + (slot >= 7 ? 1 : 0)) % 12], slot == 0 ? " O'CLOCK" : "");
+    for (const char *c = phrase; *c; c++)
+    {
+        if (*c != ' ')
+        {
+            *text++ = *c;
+        }
+    }
+    *text = '\0';
+}
+
+// Letters under the lit LEDs in reading order
+static void litLetters(const LedMask &mask, char *text)
+{
+    for (uint8_t row = 0; row < 10; row++)
+    {
+        for (uint8_t col = 0; col < 12; col++)
+        {
+            if (mask.test(referenceWiring[row][col]))
+            {
+                *text++ = Face::letters[row][col];
+            }
+        }
+    }
+    *text = '\0';
+}
+
+// Host reference for local time, glibc reading the same POSIX rule
+static bool referenceLocal(uint32_t utc, struct tm &local)
+{
+    time_t epoch = utc;
+    return localtime_r(&epoch, &local) != nullptr;
+}
+
+static void printMask(FILE *file, const LedMask &mask)
+{
+    for (int8_t i = LED_MASK_WORDS - 1; i >= 0; i--)
+    {
+        fprintf(file, "%08x", mask.bits[i]);
+    }
+}
+
+int runReplay(int argc, char **argv)
+{
+    uint16_t year = REPLAY_YEAR;
+    const char *rule = REPLAY_TZ_RULE;
+    uint32_t step_s = REPLAY_STEP_S;
+    uint64_t millis_start = REPLAY_MILLIS_START;
+    const char *out_path = nullptr;
+    uint32_t days = 0; // The whole year
+    bool full = false;
+    for (int i = 0; i < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--full") == 0)
+        {
+            full = true;
+            i--;
+        }
+        else if (i + 1 >= argc)
+        {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            return 2;
+        }
+        else if (strcmp(argv[i], "--year") == 0)
+        {
+            year = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--days") == 0)
+        {
+            days = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--tz") == 0)
+        {
+            rule = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--step") == 0)
+        {
+            step_s = atoi(argv[i + 1]) > 0 ? atoi(argv[i + 1]) : 1;
+        }
+        else if (strcmp(argv[i], "--millis-start") == 0)
+        {
+            millis_start = strtoull(argv[i + 1], nullptr, 0);
+        }
+        else if (strcmp(argv[i], "--out") == 0)
+        {
+            out_path = argv[i + 1];
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (year < 1971 || year > 2105)
+    {
+        fprintf(stderr, "Year out of range\n");
+        return 2;
+    }
+
+    FILE *out = nullptr;
+    if (out_path)
+    {
+        out = fopen(out_path, "w");
+        if (!out)
+        {
+            fprintf(stderr, "Cannot write %s\n", out_path);
+            return 2;
+        }
+        fprintf(out, "utc,local,dst,reference_dst,mask\n");
+    }
+
+    // Bring the sketch up on simulated time, offline so no NTP traffic goes out
+    simClockStart(millis_start * 1000);
+    halSetWiFiStatus(WL_DISCONNECTED);
+    halSetSerialMuted(true);
+    setup();
+    if (!tz.begin(rule))
+    {
+        halSetSerialMuted(false);
+        fprintf(stderr, "Bad timezone rule %s\n", rule);
+        return 2;
+    }
+    setenv("TZ", rule, 1);
+    tzset();
+
+    uint32_t start = daysFromCivil(year, 1, 1) * SECONDS_PER_DAY;
+    uint32_t end = daysFromCivil(year + 1, 1, 1) * SECONDS_PER_DAY;
+    if (days && start + days * SECONDS_PER_DAY < end)
+    {
+        end = start + days * SECONDS_PER_DAY;
+    }
+    days = (end - start) / SECONDS_PER_DAY;
+    rtc.setEpoch(start);
+
+    bool check_phrase = referenceFace();
+    uint32_t steps = 0;
+    uint32_t mismatches = 0;
+    uint32_t stalls = 0;
+    uint32_t millis_wraps = 0;
+    uint32_t dst_changes = 0;
+    uint32_t last_millis = millis();
+    bool last_dst = false;
+    uint64_t day_ns = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_day_ns = 0;
+    const Task *render = nullptr;
+    uint32_t overruns = 0;
+    for (uint8_t i = 0; i < scheduler.count(); i++)
+    {
+        render = strcmp(scheduler.task(i).name, "render") == 0 ? &scheduler.task(i) : render;
+        overruns -= scheduler.task(i).overruns;
+    }
+    uint32_t frames = render ? render->runs : 0;
+    for (uint32_t utc = start; utc < end; utc += step_s)
+    {
+        // Run everything due at this step, as loop() would
+        auto host_start = std::chrono::steady_clock::now();
+        for (uint8_t i = 0; i < REPLAY_MAX_RUNS && scheduler.runOnce(); i++)
+        {
+        }
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - host_start).count();
+        day_ns += ns;
+        total_ns += ns;
+
+        struct tm reference;
+        referenceLocal(utc, reference);
+        bool reference_dst = reference.tm_isdst > 0;
+        char expected[WC_LEDS + 1] = "";
+        char lit[WC_LEDS + 1] = "";
+        if (check_phrase)
+        {
+            referencePhrase(reference.tm_hour, reference.tm_min, expected);
+            litLetters(wordLayer.mask(), lit);
+        }
+
+        if (timeNow.utc != utc)
+        {
+            stalls++;
+        }
+        else if (timeNow.dst != reference_dst || timeNow.time.hour != reference.tm_hour ||
+                 timeNow.time.minute != reference.tm_min || strcmp(lit, expected) != 0)
+        {
+            if (mismatches < REPLAY_MAX_REPORTS)
+            {
+                printf("Mismatch at %u: local %02u:%02u dst %u %s, reference %02d:%02d dst %u %s\n",
+                       utc, timeNow.time.hour, timeNow.time.minute, timeNow.dst, lit,
+                       reference.tm_hour, reference.tm_min, reference_dst, expected);
+            }
+            mismatches++;
+        }
+        if (steps && timeNow.dst != last_dst)
+        {
+            dst_changes++;
+        }
+        last_dst = timeNow.dst;
+
+        if (out)
+        {
+            fprintf(out, "%u,%04u-%02u-%02u %02u:%02u,%u,%u,", utc, timeNow.time.year, timeNow.time.month,
+                    timeNow.time.day, timeNow.time.hour, timeNow.time.minute, timeNow.dst, reference_dst);
+            printMask(out, wordLayer.mask());
+            fprintf(out, "\n");
+        }
+
+        if (full)
+        {
+            // Every tick up to the next step, which runs at the top of the loop
+            auto tick_start = std::chrono::steady_clock::now();
+            for (uint32_t ms = REPLAY_TICK_MS; ms < step_s * 1000; ms += REPLAY_TICK_MS)
+            {
+                simClockAdvance(REPLAY_TICK_MS * 1000);
+                while (scheduler.runOnce())
+                {
+                }
+            }
+            simClockAdvance(REPLAY_TICK_MS * 1000);
+            uint64_t tick_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tick_start).count();
+            day_ns += tick_ns;
+            total_ns += tick_ns;
+        }
+        else
+        {
+            simClockAdvance((uint64_t)step_s * 1000000);
+        }
+        // Day boundaries in UTC
+        steps++;
+        if ((utc + step_s) / SECONDS_PER_DAY != utc / SECONDS_PER_DAY)
+        {
+            max_day_ns = day_ns > max_day_ns ? day_ns : max_day_ns;
+            day_ns = 0;
+        }
+
+        if (millis() < last_millis)
+        {
+            millis_wraps++;
+        }
+        last_millis = millis();
+    }
+    simClockStop();
+    halSetSerialMuted(false);
+    if (out)
+    {
+        fclose(out);
+    }
+
+    frames = render ? render->runs - frames : 0;
+    for (uint8_t i = 0; i < scheduler.count(); i++)
+    {
+        overruns += scheduler.task(i).overruns;
+    }
+    printf("Replayed %u: %u steps of %u s over %u days, %s%s\n", year, steps, step_s, days, rule,
+           full ? ", every tick" : "");
+    printf("DST changes: %u, millis() wraps: %u\n", dst_changes, millis_wraps);
+    if (full)
+    {
+        printf("Frames: %u, task overruns: %u\n", frames, overruns);
+        printf("Host CPU per simulated day, measured: %.1f ms mean, %.1f ms max\n", total_ns / 1e6 / days,
+               max_day_ns / 1e6);
+    }
+    else if (days && render)
+    {
+        // Every task is late after a jump, so overruns are not counted here
+        printf("Frames: %u, one per step\n", frames);
+        // Frames in a real day at the render period the governor settled on
+        uint32_t day_frames = SECONDS_PER_DAY * 1000 / render->period_ms;
+        printf("Host CPU per step (one frame and the other due tasks): %.1f us mean\n", total_ns / 1e3 / steps);
+        printf("Host CPU per simulated day, estimated for %u frames at %u ms: %.1f ms\n", day_frames,
+               render->period_ms, total_ns / 1e6 / steps * day_frames);
+    }
+    printf("Phrases %s\n", check_phrase ? "checked against the reference" : "not checked, no reference for this face");
+    printf("Mismatches: %u, steps without a new frame: %u\n", mismatches, stalls);
+    return (mismatches || stalls) ? 1 : 0;
+}
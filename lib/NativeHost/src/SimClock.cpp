@@ -0,0 +1,33 @@
+#include "SimClock.h"
+
+#include "NativeHal.h"
+
+static uint64_t simMicros = 0;
+
+static void simSleep(uint64_t us)
+{
+    simMicros += us;
+}
+
+static const HalClock simClock = {simClockMicros, simSleep};
+
+void simClockStart(uint64_t start_us)
+{
+    simMicros = start_us;
+    halSetClock(&simClock);
+}
+
+void simClockStop()
+{
+    halSetClock(nullptr);
+}
+
+void simClockAdvance(uint64_t us)
+{
+    simMicros += us;
+}
+
+uint64_t simClockMicros()
+{
+    return simMicros;
+}
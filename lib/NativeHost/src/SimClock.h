@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+
+// Simulated time for the native build
+//  Only moves when advanced, or by delay(), so days of sketch time run in
+//  seconds. millis(), micros() and the RTC all follow it once started.
+void simClockStart(uint64_t start_us); // Switch from the host clock, starting at start_us
+void simClockStop();                   // Back to the host clock
+void simClockAdvance(uint64_t us);
+uint64_t simClockMicros();
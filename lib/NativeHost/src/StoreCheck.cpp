@@ -0,0 +1,222 @@
+#include <Arduino.h>
+
+#include <stdlib.h>
+
+#include "NativeHal.h"
+#include "SettingsStore.h"
+
+// Settings store check
+//  Drives a SettingsStore on the RAM flash with random writes, reopening it
+//  now and then as a reset would and comparing every key against a model.
+//  Then cuts the power part way through writes, including compactions,
+//  and checks that only the key being written may keep its old value.
+//
+//  program store [--writes N] [--cuts N] [--seed S]
+
+const uint32_t STORE_WRITES = 20000;
+const uint32_t STORE_CUTS = 2000;
+const uint32_t STORE_REOPEN_EVERY = 101; // Writes between reopens
+const uint8_t STORE_HOT_KEYS = 4;        // Half the writes go to these, like a few often tweaked settings
+
+struct StoreModel
+{
+    uint8_t value[SETTINGS_KEYS][SETTINGS_VALUE_MAX];
+    uint8_t len[SETTINGS_KEYS];
+    bool set[SETTINGS_KEYS];
+};
+
+static uint32_t storeSeed = 1;
+
+// xorshift32, the sketch's random16() is left alone
+static uint32_t storeRandom(uint32_t limit)
+{
+    storeSeed ^= storeSeed << 13;
+    storeSeed ^= storeSeed >> 17;
+    storeSeed ^= storeSeed << 5;
+    return storeSeed % limit;
+}
+
+static uint8_t randomKey()
+{
+    return storeRandom(2) ? storeRandom(STORE_HOT_KEYS) : storeRandom(SETTINGS_KEYS);
+}
+
+static uint8_t randomValue(uint8_t *value)
+{
+    uint8_t len = storeRandom(SETTINGS_VALUE_MAX + 1);
+    for (uint8_t i = 0; i < len; i++)
+    {
+        value[i] = storeRandom(256);
+    }
+    return len;
+}
+
+static bool matches(SettingsStore &store, const StoreModel &model, uint8_t key)
+{
+    uint8_t value[SETTINGS_VALUE_MAX];
+    uint8_t len = store.read(key, value, sizeof(value));
+    if (!model.set[key])
+    {
+        return len == 0;
+    }
+    return len == model.len[key] && memcmp(value, model.value[key], len) == 0;
+}
+
+// Keys that differ from the model, skipping one
+static uint32_t lostKeys(SettingsStore &store, const StoreModel &model, int16_t skip)
+{
+    uint32_t lost = 0;
+    for (uint8_t k = 0; k < SETTINGS_KEYS; k++)
+    {
+        if (k != skip && !matches(store, model, k))
+        {
+            lost++;
+        }
+    }
+    return lost;
+}
+
+static void remember(StoreModel &model, uint8_t key, const uint8_t *value, uint8_t len)
+{
+    memcpy(model.value[key], value, len);
+    model.len[key] = len;
+    model.set[key] = true;
+}
+
+static uint32_t totalErases()
+{
+    uint32_t total = 0;
+    for (uint32_t row = 0; row < NVM_FLASH_SIZE / NVM_FLASH_ROW; row++)
+    {
+        total += halFlashErases(row);
+    }
+    return total;
+}
+
+int runStoreCheck(int argc, char **argv)
+{
+    uint32_t writes = STORE_WRITES;
+    uint32_t cuts = STORE_CUTS;
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--writes") == 0)
+        {
+            writes = strtoul(argv[i + 1], nullptr, 0);
+        }
+        else if (strcmp(argv[i], "--cuts") == 0)
+        {
+            cuts = strtoul(argv[i + 1], nullptr, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            storeSeed = strtoul(argv[i + 1], nullptr, 0) | 1;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    halFlashReset();
+    NvmFlash flash;
+    SettingsStore store(flash);
+    StoreModel model = {};
+    if (!store.begin())
+    {
+        printf("Cannot format the store\n");
+        return 1;
+    }
+
+    // Random writes with a reset every so often
+    uint32_t lost = 0;
+    uint32_t failed = 0;
+    uint32_t compactions = 0;
+    uint32_t reopens = 0;
+    for (uint32_t i = 0; i < writes; i++)
+    {
+        uint8_t value[SETTINGS_VALUE_MAX];
+        uint8_t key = randomKey();
+        uint8_t len = randomValue(value);
+        if (!store.write(key, value, len))
+        {
+            failed++;
+            continue;
+        }
+        remember(model, key, value, len);
+        if ((i + 1) % STORE_REOPEN_EVERY == 0)
+        {
+            compactions += store.compactions();
+            store.begin();
+            reopens++;
+            lost += lostKeys(store, model, -1);
+        }
+    }
+    compactions += store.compactions();
+    store.begin();
+    lost += lostKeys(store, model, -1);
+
+    uint32_t min_erases = UINT32_MAX;
+    uint32_t max_erases = 0;
+    for (uint32_t row = 0; row < NVM_FLASH_SIZE / NVM_FLASH_ROW; row++)
+    {
+        uint32_t erases = halFlashErases(row);
+        min_erases = erases < min_erases ? erases : min_erases;
+        max_erases = erases > max_erases ? erases : max_erases;
+    }
+    bool writes_failed = lost || failed || halFlashOverwrites() || max_erases - min_erases > 1;
+    printf("writes: %u (%u compactions), reopened %u times, %u failed, %u values lost  %s\n", writes,
+           compactions, reopens, failed, lost, lost || failed ? "FAILED" : "ok");
+    printf("row erases: %u to %u, %u words overwritten  %s\n", min_erases, max_erases, halFlashOverwrites(),
+           halFlashOverwrites() || max_erases - min_erases > 1 ? "FAILED" : "ok");
+
+    // Power cuts anywhere in a record or a compaction, then a reset
+    uint32_t cut_lost = 0;
+    uint32_t cut_compactions = 0;
+    uint32_t recovered = 0;
+    for (uint32_t i = 0; i < cuts; i++)
+    {
+        uint8_t value[SETTINGS_VALUE_MAX];
+        uint8_t key = randomKey();
+        uint8_t len = randomValue(value);
+        uint32_t erases = totalErases();
+
+        halFlashCutAfter(storeRandom(SETTINGS_SECTOR_SIZE + 64));
+        bool written = store.write(key, value, len);
+        halFlashCutAfter(-1);
+        if (totalErases() != erases)
+        {
+            cut_compactions++;
+        }
+
+        store.begin();
+        cut_lost += lostKeys(store, model, key);
+        if (written)
+        {
+            // Finished before the power went, so it has to be there
+            remember(model, key, value, len);
+            cut_lost += matches(store, model, key) ? 0 : 1;
+            continue;
+        }
+        if (matches(store, model, key))
+        {
+            continue;
+        }
+        uint8_t stored[SETTINGS_VALUE_MAX];
+        if (store.read(key, stored, sizeof(stored)) == len && memcmp(stored, value, len) == 0)
+        {
+            // The record was complete, only the return was lost
+            remember(model, key, value, len);
+            recovered++;
+        }
+        else
+        {
+            cut_lost++;
+        }
+    }
+    cut_lost += lostKeys(store, model, -1);
+    printf("power cuts: %u (%u in a compaction), %u written anyway, %u values lost  %s\n", cuts,
+           cut_compactions, recovered, cut_lost, cut_lost ? "FAILED" : "ok");
+
+    return writes_failed || cut_lost ? 1 : 0;
+}
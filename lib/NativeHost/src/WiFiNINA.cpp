@@ -0,0 +1,262 @@
+#include <WiFiNINA.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "NativeHal.h"
+
+WiFiClass WiFi;
+
+static int wifiStatus = WL_CONNECTED; // The host network stands in for the access point
+
+// WiFi
+
+int WiFiClass::status()
+{
+    return wifiStatus;
+}
+
+int WiFiClass::begin(const char *, const char *)
+{
+    return wifiStatus;
+}
+
+// Host resolver, blocking like the module's
+int WiFiClass::hostByName(const char *host, IPAddress &ip)
+{
+    addrinfo hints = {};
+    addrinfo *result;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, nullptr, &hints, &result) != 0)
+    {
+        return 0;
+    }
+    ip = IPAddress((uint32_t)((sockaddr_in *)result->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(result);
+    return 1;
+}
+
+uint32_t WiFiClass::getTime()
+{
+    return (uint32_t)time(nullptr);
+}
+
+void halSetWiFiStatus(int status)
+{
+    wifiStatus = status;
+}
+
+// UDP, non-blocking host socket
+
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+    m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_fd < 0)
+    {
+        return 0;
+    }
+    fcntl(m_fd, F_SETFL, O_NONBLOCK);
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(m_fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiUDP::stop()
+{
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+    m_fd = -1;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+    m_tx_ip = ip;
+    m_tx_port = port;
+    m_tx_len = 0;
+    return 1;
+}
+
+int WiFiUDP::beginPacket(const char *host, uint16_t port)
+{
+    IPAddress ip;
+    return WiFi.hostByName(host, ip) && beginPacket(ip, port);
+}
+
+size_t WiFiUDP::write(const uint8_t *buffer, size_t size)
+{
+    if (m_tx_len + size > sizeof(m_tx))
+    {
+        size = sizeof(m_tx) - m_tx_len;
+    }
+    memcpy(m_tx + m_tx_len, buffer, size);
+    m_tx_len += size;
+    return size;
+}
+
+int WiFiUDP::endPacket()
+{
+    if (m_fd < 0)
+    {
+        return 0;
+    }
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(m_tx_port);
+    addr.sin_addr.s_addr = (uint32_t)m_tx_ip;
+    return sendto(m_fd, m_tx, m_tx_len, 0, (sockaddr *)&addr, sizeof(addr)) == (ssize_t)m_tx_len;
+}
+
+int WiFiUDP::parsePacket()
+{
+    m_rx_len = 0;
+    m_rx_pos = 0;
+    if (m_fd < 0)
+    {
+        return 0;
+    }
+    sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    ssize_t received = recvfrom(m_fd, m_rx, sizeof(m_rx), 0, (sockaddr *)&addr, &addr_len);
+    if (received <= 0)
+    {
+        return 0;
+    }
+    m_rx_len = received;
+    m_remote_ip = IPAddress((uint32_t)addr.sin_addr.s_addr);
+    m_remote_port = ntohs(addr.sin_port);
+    return received;
+}
+
+int WiFiUDP::read(unsigned char *buffer, size_t len)
+{
+    int count = 0;
+    while ((size_t)count < len && m_rx_pos < m_rx_len)
+    {
+        buffer[count++] = m_rx[m_rx_pos++];
+    }
+    return count;
+}
+
+// TCP, non-blocking host sockets
+
+uint8_t WiFiClient::connected()
+{
+    if (m_fd < 0)
+    {
+        return 0;
+    }
+    uint8_t c;
+    ssize_t peeked = recv(m_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    return peeked > 0 || (peeked < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
+
+int WiFiClient::available()
+{
+    int count = 0;
+    if (m_fd < 0 || ioctl(m_fd, FIONREAD, &count) < 0)
+    {
+        return 0;
+    }
+    return count;
+}
+
+int WiFiClient::read()
+{
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size)
+{
+    if (m_fd < 0)
+    {
+        return -1;
+    }
+    ssize_t received = recv(m_fd, buffer, size, MSG_DONTWAIT);
+    return received > 0 ? received : -1;
+}
+
+int WiFiClient::peek()
+{
+    uint8_t c;
+    return m_fd >= 0 && recv(m_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+// Takes what the socket buffer has room for, like the module
+size_t WiFiClient::write(const uint8_t *buffer, size_t size)
+{
+    if (m_fd < 0)
+    {
+        return 0;
+    }
+    ssize_t sent = send(m_fd, buffer, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+    return sent > 0 ? sent : 0;
+}
+
+void WiFiClient::stop()
+{
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+    m_fd = -1;
+}
+
+void WiFiServer::begin()
+{
+    if (m_fd >= 0)
+    {
+        return;
+    }
+    m_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_fd < 0)
+    {
+        return;
+    }
+    int reuse = 1;
+    setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    fcntl(m_fd, F_SETFL, O_NONBLOCK);
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(m_port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(m_fd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(m_fd, 4) < 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+WiFiClient WiFiServer::available()
+{
+    if (m_fd < 0)
+    {
+        return WiFiClient();
+    }
+    int fd = accept(m_fd, nullptr, nullptr);
+    if (fd < 0)
+    {
+        return WiFiClient();
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    return WiFiClient(fd);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <Udp.h>
+
+// WiFiNINA stand-in for the native build
+//  The link status comes from the host (see NativeHal.h), UDP and TCP go
+//  through the host's sockets.
+
+#define WL_IDLE_STATUS 0
+#define WL_NO_SSID_AVAIL 1
+#define WL_CONNECTED 3
+#define WL_CONNECT_FAILED 4
+#define WL_CONNECTION_LOST 5
+#define WL_DISCONNECTED 6
+
+class WiFiClass
+{
+public:
+    int status();
+    int begin(const char *ssid, const char *passphrase);
+    int hostByName(const char *host, IPAddress &ip);
+    uint32_t getTime();
+};
+
+extern WiFiClass WiFi;
+
+class WiFiUDP : public UDP
+{
+public:
+    uint8_t begin(uint16_t port) override;
+    void stop() override;
+
+    int beginPacket(IPAddress ip, uint16_t port) override;
+    int beginPacket(const char *host, uint16_t port) override;
+    int endPacket() override;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    int parsePacket() override;
+    int available() override { return m_rx_len - m_rx_pos; }
+    int read() override { return m_rx_pos < m_rx_len ? m_rx[m_rx_pos++] : -1; }
+    int read(unsigned char *buffer, size_t len) override;
+    int read(char *buffer, size_t len) override { return read((unsigned char *)buffer, len); }
+    int peek() override { return m_rx_pos < m_rx_len ? m_rx[m_rx_pos] : -1; }
+    void flush() override {}
+
+    IPAddress remoteIP() override { return m_remote_ip; }
+    uint16_t remotePort() override { return m_remote_port; }
+
+private:
+    int m_fd = -1;
+
+    uint8_t m_tx[1500];
+    size_t m_tx_len = 0;
+    IPAddress m_tx_ip;
+    uint16_t m_tx_port = 0;
+
+    uint8_t m_rx[1500];
+    int m_rx_len = 0;
+    int m_rx_pos = 0;
+    IPAddress m_remote_ip;
+    uint16_t m_remote_port = 0;
+};
+
+// TCP connection, a non-blocking host socket shared by copies like the
+// module's socket number
+class WiFiClient : public Stream
+{
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd) : m_fd(fd) {}
+
+    uint8_t connected();
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size);
+    int peek() override;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    void stop();
+
+    explicit operator bool() const { return m_fd >= 0; }
+
+private:
+    int m_fd = -1;
+};
+
+// TCP listener on all host interfaces
+class WiFiServer
+{
+public:
+    explicit WiFiServer(uint16_t port) : m_port(port) {}
+
+    void begin();
+
+    // Next waiting connection, or a client that tests false
+    WiFiClient available();
+
+private:
+    uint16_t m_port;
+    int m_fd = -1;
+};
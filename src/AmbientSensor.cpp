@@ -0,0 +1,56 @@
+#include "AmbientSensor.h"
+
+#if defined(ARDUINO_ARCH_SAMD)
+
+#include <wiring_private.h>
+
+static void adcSync()
+{
+    while (ADC->STATUS.bit.SYNCBUSY)
+        ;
+}
+
+void AmbientSensor::begin(uint8_t pin)
+{
+    m_pin = pin;
+    pinPeripheral(pin, PIO_ANALOG);
+
+    ADC->CTRLA.bit.ENABLE = 0;
+    adcSync();
+
+    // Reference and calibration stay as the core set them (VDDANA/2 with gain 1/2, full 3.3 V range)
+    ADC->INPUTCTRL.reg = ADC_INPUTCTRL_MUXPOS(g_APinDescription[pin].ulADCChannelNumber) | ADC_INPUTCTRL_MUXNEG_GND |
+                         ADC_INPUTCTRL_GAIN_DIV2;
+    adcSync();
+
+    // 16 conversions summed and shifted back to 12 bits per result
+    ADC->AVGCTRL.reg = ADC_AVGCTRL_SAMPLENUM_16 | ADC_AVGCTRL_ADJRES(4);
+    ADC->SAMPCTRL.reg = ADC_SAMPCTRL_SAMPLEN(63); // Longest sampling time, the sensor divider is high impedance
+    ADC->CTRLB.reg = ADC_CTRLB_PRESCALER_DIV512 | ADC_CTRLB_RESSEL_16BIT | ADC_CTRLB_FREERUN;
+    adcSync();
+
+    ADC->CTRLA.bit.ENABLE = 1;
+    adcSync();
+    ADC->SWTRIG.bit.START = 1;
+}
+
+uint16_t AmbientSensor::read()
+{
+    // RESULT always holds the last finished average, reading it needs no sync
+    return ADC->RESULT.reg;
+}
+
+#else
+
+void AmbientSensor::begin(uint8_t pin)
+{
+    m_pin = pin;
+}
+
+uint16_t AmbientSensor::read()
+{
+    // 10-bit analogRead() scaled to the same range
+    return analogRead(m_pin) << 2;
+}
+
+#endif
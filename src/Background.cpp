@@ -0,0 +1,231 @@
+#include "Background.h"
+
+// Rainbow
+//  Samples a cached noise field, which fills in over the first frames.
+//  Panels too big for the lattice use the exact walk.
+
+struct RainbowState
+{
+    NoiseField<RAINBOW_LATTICE> field;
+};
+
+static bool beginRainbow(void *state, const PanelView &panel)
+{
+    ((RainbowState *)state)->field.begin(rainbowRadius(panel));
+    return true;
+}
+
+static void renderRainbow(void *state, CRGB *leds, const PanelView &panel, const EffectFrame &frame)
+{
+    NoiseField<RAINBOW_LATTICE> &field = ((RainbowState *)state)->field;
+    // A row a frame until the lattice is full, without it every sample is
+    // an exact inoise16
+    if (!field.ready())
+    {
+        field.refresh();
+    }
+    rainbowWalk(leds, panel, frame.step, field);
+}
+
+// Plasma
+//  Three sine waves, along x, along y and along the diagonal, moving at
+//  different speeds. Their sum picks the hue.
+
+static void renderPlasma(void *, CRGB *leds, const PanelView &panel, const EffectFrame &frame)
+{
+    uint8_t t = frame.step;
+    uint8_t t2 = frame.step / 2;
+    for (uint16_t i = 0; i < panel.leds; i++)
+    {
+        PanelPoint p = panel.point[i];
+        uint16_t sum = sin8(p.x * 16 + t) + sin8(p.y * 16 - t2) + sin8((p.x + p.y) * 8 + t2);
+        leds[i].setHue(sum / 3 + frame.hue).nscale8(EFFECT_LEVEL);
+    }
+}
+
+// Fire
+//  Heat per grid cell, rows top to bottom. Every frame the cells cool a
+//  little, heat rises one row, spreading sideways, and sparks start in
+//  the bottom row.
+
+const uint8_t FIRE_COOLING = 30;  // Higher burns out sooner
+const uint8_t FIRE_SPARKING = 60; // Chance of a spark per bottom cell and frame, out of 255
+
+struct FireState
+{
+    uint8_t heat[EFFECT_MAX_LEDS]; // [y * width + x]
+};
+
+static bool beginFire(void *, const PanelView &panel)
+{
+    return panel.leds <= EFFECT_MAX_LEDS && panel.height >= 2;
+}
+
+static void renderFire(void *state, CRGB *leds, const PanelView &panel, const EffectFrame &)
+{
+    uint8_t *heat = ((FireState *)state)->heat;
+    uint16_t w = panel.width;
+    uint16_t h = panel.height;
+
+    uint8_t cooling = (FIRE_COOLING * 10) / h + 2;
+    for (uint16_t i = 0; i < panel.leds; i++)
+    {
+        heat[i] = qsub8(heat[i], random8(0, cooling));
+    }
+    // Top down, so each row takes the row below from the last frame
+    for (uint16_t y = 0; y < h - 1; y++)
+    {
+        uint8_t *row = heat + y * w;
+        const uint8_t *below = row + w;
+        for (uint16_t x = 0; x < w; x++)
+        {
+            uint8_t left = below[x > 0 ? x - 1 : x];
+            uint8_t right = below[x + 1 < w ? x + 1 : x];
+            row[x] = (left + below[x] * 2 + right) / 4;
+        }
+    }
+    uint8_t *bottom = heat + (h - 1) * w;
+    for (uint16_t x = 0; x < w; x++)
+    {
+        if (random8() < FIRE_SPARKING)
+        {
+            bottom[x] = qadd8(bottom[x], random8(160, 255));
+        }
+    }
+
+    for (uint16_t i = 0; i < panel.leds; i++)
+    {
+        PanelPoint p = panel.point[i];
+        leds[i] = HeatColor(heat[p.y * w + p.x]).nscale8(EFFECT_LEVEL);
+    }
+}
+
+// Starfield
+//  Stars start at the centre and fly out in straight lines, getting
+//  brighter as they go. Off the grid they start again.
+
+const uint8_t STARS = 16;
+
+struct Star
+{
+    int16_t x; // Grid cells from the centre, Q8
+    int16_t y;
+    int8_t dx; // Q8 cells per frame
+    int8_t dy;
+    uint8_t age; // Frames since the start
+};
+
+struct StarfieldState
+{
+    Star stars[STARS];
+};
+
+static void launchStar(Star &star)
+{
+    uint16_t angle = random16();
+    uint8_t speed = random8(24, 128);
+    star.x = 0;
+    star.y = 0;
+    star.dx = ((int32_t)cos16(angle) * speed) >> 15;
+    star.dy = ((int32_t)sin16(angle) * speed) >> 15;
+    star.age = 0;
+}
+
+static bool beginStarfield(void *state, const PanelView &)
+{
+    StarfieldState *field = (StarfieldState *)state;
+    for (uint8_t i = 0; i < STARS; i++)
+    {
+        launchStar(field->stars[i]);
+        // Spread them out so they do not all leave together
+        field->stars[i].age = random8(32);
+        field->stars[i].x = field->stars[i].dx * field->stars[i].age;
+        field->stars[i].y = field->stars[i].dy * field->stars[i].age;
+    }
+    return true;
+}
+
+static void renderStarfield(void *state, CRGB *leds, const PanelView &panel, const EffectFrame &frame)
+{
+    StarfieldState *field = (StarfieldState *)state;
+    for (uint16_t i = 0; i < panel.leds; i++)
+    {
+        leds[i].setRGB(0, 0, 0);
+    }
+
+    int32_t centre_x = panel.width * 128;
+    int32_t centre_y = panel.height * 128;
+    for (uint8_t i = 0; i < STARS; i++)
+    {
+        Star &star = field->stars[i];
+        star.x += star.dx;
+        star.y += star.dy;
+        star.age = qadd8(star.age, 1);
+
+        int32_t x = (centre_x + star.x) >> 8;
+        int32_t y = (centre_y + star.y) >> 8;
+        if (x < 0 || y < 0 || x >= panel.width || y >= panel.height || (star.dx == 0 && star.dy == 0))
+        {
+            launchStar(star);
+            continue;
+        }
+        uint8_t level = scale8(qadd8(star.age * 8, 48), EFFECT_LEVEL);
+        leds[panel.index[y * panel.width + x]].setHue(frame.hue).nscale8(level);
+    }
+}
+
+// Twinkle
+//  Per LED level in strip order. Levels decay each frame and a few random
+//  LEDs flare up to full.
+
+const uint8_t TWINKLE_DECAY = 240;  // Level kept per frame, out of 255
+const uint8_t TWINKLE_CHANCE = 160; // Chance of a new flare per frame, out of 255
+
+struct TwinkleState
+{
+    uint8_t level[EFFECT_MAX_LEDS];
+};
+
+static bool beginTwinkle(void *, const PanelView &panel)
+{
+    return panel.leds <= EFFECT_MAX_LEDS;
+}
+
+static void renderTwinkle(void *state, CRGB *leds, const PanelView &panel, const EffectFrame &frame)
+{
+    uint8_t *level = ((TwinkleState *)state)->level;
+    if (random8() < TWINKLE_CHANCE)
+    {
+        level[random16(panel.leds)] = 255;
+    }
+    CRGB colour;
+    colour.setHue(frame.hue);
+    for (uint16_t i = 0; i < panel.leds; i++)
+    {
+        level[i] = scale8(level[i], TWINKLE_DECAY);
+        leds[i] = colour;
+        leds[i].nscale8(scale8(level[i], EFFECT_LEVEL));
+    }
+}
+
+// Solid
+
+static void renderSolid(void *, CRGB *leds, const PanelView &panel, const EffectFrame &frame)
+{
+    CRGB colour;
+    colour.setHue(frame.hue).nscale8(EFFECT_LEVEL);
+    for (uint16_t i = 0; i < panel.leds; i++)
+    {
+        leds[i] = colour;
+    }
+}
+
+constexpr Effect backgroundEffects[EFFECTS] = {
+    {"rainbow", EFFECT_STATE(RainbowState), beginRainbow, renderRainbow},
+    {"plasma", EFFECT_STATELESS, nullptr, renderPlasma},
+    {"fire", EFFECT_STATE(FireState), beginFire, renderFire},
+    {"starfield", EFFECT_STATE(StarfieldState), beginStarfield, renderStarfield},
+    {"twinkle", EFFECT_STATE(TwinkleState), beginTwinkle, renderTwinkle},
+    {"solid", EFFECT_STATELESS, nullptr, renderSolid},
+};
+static_assert(effectsFitArena(backgroundEffects, EFFECTS), "Raise EFFECT_ARENA_SIZE");
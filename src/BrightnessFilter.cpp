@@ -0,0 +1,61 @@
+#include "BrightnessFilter.h"
+
+// CIE 1931 lightness to luminance, 0..255 at every 1/32 of the input range
+static const uint8_t lightnessCurve[33] = {
+    0, 1, 2, 3, 4, 5, 7, 9, 11, 14, 17, 21, 25, 30, 35, 41, 47,
+    54, 62, 70, 79, 89, 99, 111, 123, 136, 150, 165, 181, 198, 216, 235, 255};
+
+uint16_t BrightnessFilter::update(uint16_t sample)
+{
+    if (!m_primed)
+    {
+        for (uint8_t i = 0; i < BRIGHTNESS_MEDIAN; i++)
+        {
+            m_window[i] = sample;
+        }
+        m_smooth = (int32_t)sample << 4;
+        m_held = sample;
+        m_primed = true;
+    }
+    m_window[m_next] = sample;
+    m_next = (m_next + 1) % BRIGHTNESS_MEDIAN;
+
+    // Median by insertion sort of a copy, the window is tiny
+    uint16_t sorted[BRIGHTNESS_MEDIAN];
+    for (uint8_t i = 0; i < BRIGHTNESS_MEDIAN; i++)
+    {
+        uint16_t value = m_window[i];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > value; j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = value;
+    }
+    uint16_t median = sorted[BRIGHTNESS_MEDIAN / 2];
+
+    m_smooth += (((int32_t)median << 4) - m_smooth) >> BRIGHTNESS_IIR_SHIFT;
+    int32_t smooth = (m_smooth + 8) >> 4;
+
+    // The ends of the range are always reached, so full and minimum brightness stay possible
+    bool at_end = smooth <= 0 || smooth >= 4095;
+    if (smooth > m_held + BRIGHTNESS_HYSTERESIS || smooth < m_held - BRIGHTNESS_HYSTERESIS || (at_end && smooth != m_held))
+    {
+        m_held = smooth;
+    }
+    return m_held;
+}
+
+uint8_t perceptualBrightness(uint16_t level, uint8_t min_brightness)
+{
+    if (level > 4095)
+    {
+        level = 4095;
+    }
+    // Stretch 0..4095 onto the 32 table steps of 128, then interpolate
+    uint16_t position = ((uint32_t)level * 4096 + 2047) / 4095;
+    uint8_t index = position >> 7;
+    uint8_t frac = position & 0x7F;
+    uint16_t curve = index == 32 ? 255 : lightnessCurve[index] + (((lightnessCurve[index + 1] - lightnessCurve[index]) * frac) >> 7);
+    return min_brightness + (curve * (255 - min_brightness) + 127) / 255;
+}
@@ -0,0 +1,346 @@
+#include "Console.h"
+
+#include <stdlib.h>
+
+// Split off the first word, returns the rest with leading spaces removed
+static char *splitWord(char *text)
+{
+    while (*text && *text != ' ')
+    {
+        text++;
+    }
+    if (*text)
+    {
+        *text++ = '\0';
+    }
+    while (*text == ' ')
+    {
+        text++;
+    }
+    return text;
+}
+
+static uint32_t loadNumber(const Parameter &param)
+{
+    switch (param.type)
+    {
+    case PARAM_U8:
+        return *(uint8_t *)param.value;
+    case PARAM_U16:
+        return *(uint16_t *)param.value;
+    default:
+        return *(uint32_t *)param.value;
+    }
+}
+
+static void storeNumber(const Parameter &param, uint32_t number)
+{
+    switch (param.type)
+    {
+    case PARAM_U8:
+        *(uint8_t *)param.value = number;
+        break;
+    case PARAM_U16:
+        *(uint16_t *)param.value = number;
+        break;
+    default:
+        *(uint32_t *)param.value = number;
+        break;
+    }
+}
+
+const Parameter *findParameter(const Parameter *params, uint8_t count, const char *name)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (strcmp(params[i].name, name) == 0)
+        {
+            return &params[i];
+        }
+    }
+    return nullptr;
+}
+
+static uint8_t numberWidth(const Parameter &param)
+{
+    switch (param.type)
+    {
+    case PARAM_U8:
+        return 1;
+    case PARAM_U16:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+// Store a new value, then put the previous one back if changed() refuses it
+static bool commitText(const Parameter &param, const char *text, size_t length)
+{
+    if (length >= param.max)
+    {
+        return false;
+    }
+    char previous[CONSOLE_LINE_MAX];
+    strncpy(previous, (char *)param.value, sizeof(previous) - 1);
+    previous[sizeof(previous) - 1] = '\0';
+
+    memcpy(param.value, text, length);
+    ((char *)param.value)[length] = '\0';
+    if (param.changed && !param.changed())
+    {
+        strcpy((char *)param.value, previous);
+        param.changed();
+        return false;
+    }
+    return true;
+}
+
+static bool commitNumber(const Parameter &param, uint32_t number)
+{
+    if (number < param.min || number > param.max)
+    {
+        return false;
+    }
+    uint32_t previous = loadNumber(param);
+    storeNumber(param, number);
+    if (param.changed && !param.changed())
+    {
+        storeNumber(param, previous);
+        param.changed();
+        return false;
+    }
+    return true;
+}
+
+// Number in range for the parameter, false if text is not one
+static bool parseNumber(const Parameter &param, const char *text, uint32_t &number)
+{
+    char *end;
+    unsigned long parsed = strtoul(text, &end, 0);
+    if (end == text || *end != '\0' || *text == '-' || parsed < param.min || parsed > param.max)
+    {
+        return false;
+    }
+    number = parsed;
+    return true;
+}
+
+bool checkParameter(const Parameter &param, const char *text)
+{
+    if (param.read_only)
+    {
+        return false;
+    }
+    if (param.type == PARAM_TEXT)
+    {
+        return strlen(text) < param.max;
+    }
+    uint32_t number;
+    return parseNumber(param, text, number);
+}
+
+bool setParameter(const Parameter &param, const char *text)
+{
+    if (param.read_only)
+    {
+        return false;
+    }
+
+    if (param.type == PARAM_TEXT)
+    {
+        return commitText(param, text, strlen(text));
+    }
+
+    uint32_t number;
+    return parseNumber(param, text, number) && commitNumber(param, number);
+}
+
+uint8_t parameterBytes(const Parameter &param, void *buf, uint8_t size)
+{
+    size_t length = param.type == PARAM_TEXT ? strlen((const char *)param.value) : numberWidth(param);
+    if (length > size)
+    {
+        return 0;
+    }
+    memcpy(buf, param.value, length);
+    return length;
+}
+
+bool setParameterBytes(const Parameter &param, const void *data, uint8_t len)
+{
+    if (param.read_only)
+    {
+        return false;
+    }
+    if (param.type == PARAM_TEXT)
+    {
+        return !memchr(data, '\0', len) && commitText(param, (const char *)data, len);
+    }
+    if (len != numberWidth(param))
+    {
+        return false;
+    }
+    uint32_t number = 0;
+    memcpy(&number, data, len); // Little endian on both the SAMD21 and the host
+    return commitNumber(param, number);
+}
+
+uint32_t parameterNumber(const Parameter &param)
+{
+    return loadNumber(param);
+}
+
+void printParameter(Print &out, const Parameter &param)
+{
+    out.print(param.name);
+    out.print(" = ");
+    if (param.type == PARAM_TEXT)
+    {
+        out.print((const char *)param.value);
+    }
+    else
+    {
+        out.print(loadNumber(param));
+    }
+    if (param.read_only)
+    {
+        out.print(" (read only)");
+    }
+    out.println();
+}
+
+void Console::poll()
+{
+    for (uint8_t i = 0; i < CONSOLE_BYTES_PER_TICK && m_in.available(); i++)
+    {
+        char c = m_in.read();
+        if (c == '\r' || c == '\n')
+        {
+            if (m_overflow)
+            {
+                m_out.println("Line too long");
+            }
+            else if (m_length)
+            {
+                m_line[m_length] = '\0';
+                execute(m_line);
+            }
+            m_length = 0;
+            m_overflow = false;
+        }
+        else if (m_length < CONSOLE_LINE_MAX - 1)
+        {
+            m_line[m_length++] = c;
+        }
+        else
+        {
+            m_overflow = true;
+        }
+    }
+}
+
+void Console::execute(char *line)
+{
+    while (*line == ' ')
+    {
+        line++;
+    }
+    char *args = splitWord(line);
+    if (*line == '\0')
+    {
+        return;
+    }
+
+    if (strcmp(line, "help") == 0)
+    {
+        help();
+        return;
+    }
+    if (strcmp(line, "get") == 0)
+    {
+        get(args);
+        return;
+    }
+    if (strcmp(line, "set") == 0)
+    {
+        set(args);
+        return;
+    }
+    for (uint8_t i = 0; i < m_command_count; i++)
+    {
+        if (strcmp(m_commands[i].name, line) == 0)
+        {
+            m_commands[i].run(m_out, args);
+            return;
+        }
+    }
+    m_out.print("Unknown command ");
+    m_out.print(line);
+    m_out.println(", try help");
+}
+
+void Console::help()
+{
+    m_out.println("help - this list");
+    m_out.println("get [name] - show parameters");
+    m_out.println("set name value - change a parameter");
+    for (uint8_t i = 0; i < m_command_count; i++)
+    {
+        m_out.print(m_commands[i].name);
+        m_out.print(" - ");
+        m_out.println(m_commands[i].help);
+    }
+}
+
+// All parameters, or the named one
+void Console::get(char *args)
+{
+    if (*args == '\0')
+    {
+        for (uint8_t i = 0; i < m_param_count; i++)
+        {
+            printParameter(m_out, m_params[i]);
+        }
+        return;
+    }
+    const Parameter *param = findParameter(m_params, m_param_count, args);
+    if (!param)
+    {
+        m_out.print("Unknown parameter ");
+        m_out.println(args);
+        return;
+    }
+    printParameter(m_out, *param);
+}
+
+void Console::set(char *args)
+{
+    char *value = splitWord(args);
+    const Parameter *param = findParameter(m_params, m_param_count, args);
+    if (!param)
+    {
+        m_out.print("Unknown parameter ");
+        m_out.println(args);
+        return;
+    }
+    if (!setParameter(*param, value))
+    {
+        m_out.print("Cannot set ");
+        m_out.print(param->name);
+        if (param->type != PARAM_TEXT && !param->read_only)
+        {
+            m_out.print(", range ");
+            m_out.print(param->min);
+            m_out.print(" to ");
+            m_out.print(param->max);
+        }
+        m_out.println();
+        return;
+    }
+    printParameter(m_out, *param);
+    if (m_on_set)
+    {
+        m_on_set(*param);
+    }
+}
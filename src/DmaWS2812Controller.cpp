@@ -0,0 +1,68 @@
+#if defined(ARDUINO_ARCH_SAMD)
+
+#include <SPI.h>
+
+#include "DmaWS2812Controller.h"
+
+#define WS2812_DMA_CHANNEL 0
+
+static DmacDescriptor dmaDescriptor __attribute__((aligned(16)));
+static DmacDescriptor dmaWriteback __attribute__((aligned(16)));
+static DmacDescriptor *dmaChannel = &dmaDescriptor; // Channel 0's entry in the descriptor table in use
+
+void Ws2812Dma::begin()
+{
+    // SERCOM1 as SPI master at 2.4 MHz, MOSI idles low
+    SPI.begin();
+    SPI.beginTransaction(SPISettings(WS2812_SPI_HZ, MSBFIRST, SPI_MODE0));
+
+    // DMA controller
+    //  Left running when another driver has started it, its descriptor
+    //  table is then shared. Only our channel is reset.
+    PM->AHBMASK.reg |= PM_AHBMASK_DMAC;
+    PM->APBBMASK.reg |= PM_APBBMASK_DMAC;
+    if ((DMAC->CTRL.reg & DMAC_CTRL_DMAENABLE) && DMAC->BASEADDR.reg)
+    {
+        dmaChannel = (DmacDescriptor *)DMAC->BASEADDR.reg + WS2812_DMA_CHANNEL;
+    }
+    else
+    {
+        DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;
+        DMAC->BASEADDR.reg = (uint32_t)&dmaDescriptor;
+        DMAC->WRBADDR.reg = (uint32_t)&dmaWriteback;
+        DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+    }
+
+    // One byte per SPI transmit-ready trigger
+    DMAC->CHID.reg = DMAC_CHID_ID(WS2812_DMA_CHANNEL);
+    DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+    while (DMAC->CHCTRLA.bit.ENABLE)
+    {
+    }
+    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+    while (DMAC->CHCTRLA.bit.SWRST)
+    {
+    }
+    DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(SERCOM1_DMAC_ID_TX) | DMAC_CHCTRLB_TRIGACT_BEAT;
+}
+
+bool Ws2812Dma::busy()
+{
+    // The channel disables itself when the block is done
+    DMAC->CHID.reg = DMAC_CHID_ID(WS2812_DMA_CHANNEL);
+    return DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE;
+}
+
+void Ws2812Dma::send(const uint8_t *buf, uint16_t len)
+{
+    dmaChannel->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC | DMAC_BTCTRL_BLOCKACT_NOACT;
+    dmaChannel->BTCNT.reg = len;
+    dmaChannel->SRCADDR.reg = (uint32_t)(buf + len); // End address when incrementing
+    dmaChannel->DSTADDR.reg = (uint32_t)&SERCOM1->SPI.DATA.reg;
+    dmaChannel->DESCADDR.reg = 0;
+
+    DMAC->CHID.reg = DMAC_CHID_ID(WS2812_DMA_CHANNEL);
+    DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "DriftEstimator.h"
+
+void DriftEstimator::addSample(uint32_t interval_s, int32_t offset_ms, int32_t applied_ppb)
+{
+    if (interval_s < DRIFT_MIN_SAMPLE_S)
+    {
+        return;
+    }
+    uint32_t residual_ms = offset_ms < 0 ? -offset_ms : offset_ms;
+    int32_t rate = applied_ppb - (int32_t)((int64_t)offset_ms * 1000000 / interval_s);
+
+    // The sample after a large residual decides what it was: a rate that
+    // agrees means the drift changed, anything else means a bad measurement
+    if (m_suspect_s)
+    {
+        uint32_t shorter = interval_s < m_suspect_s ? interval_s : m_suspect_s;
+        int64_t apart = (int64_t)rate - m_suspect_ppb;
+        bool agree = (apart < 0 ? -apart : apart) * shorter / 1000000 <= DRIFT_BAD_MS;
+        if (agree)
+        {
+            m_count = 0;
+            push(m_suspect_s, m_suspect_ppb);
+            push(interval_s, rate);
+            m_suspect_s = 0;
+            m_interval_s = DRIFT_MIN_INTERVAL_S;
+            return;
+        }
+        m_suspect_s = 0;
+        m_outliers++;
+    }
+    if (residual_ms > DRIFT_BAD_MS && m_count > 0)
+    {
+        m_suspect_s = interval_s;
+        m_suspect_ppb = rate;
+        m_interval_s = DRIFT_MIN_INTERVAL_S;
+        return;
+    }
+
+    push(interval_s, rate);
+    if (residual_ms > DRIFT_BAD_MS)
+    {
+        m_interval_s = DRIFT_MIN_INTERVAL_S;
+    }
+    else if (residual_ms <= DRIFT_GOOD_MS && m_count >= 2)
+    {
+        m_interval_s = m_interval_s * 2 > DRIFT_MAX_INTERVAL_S ? DRIFT_MAX_INTERVAL_S : m_interval_s * 2;
+    }
+}
+
+// Add a rate and take the estimate again
+void DriftEstimator::push(uint32_t interval_s, int32_t rate)
+{
+    m_intervals[m_head] = interval_s;
+    m_rates[m_head] = rate;
+    m_head = (m_head + 1) % DRIFT_SAMPLES;
+    if (m_count < DRIFT_SAMPLES)
+    {
+        m_count++;
+    }
+
+    int64_t weighted = 0;
+    uint64_t total = 0;
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        uint8_t n = (m_head + DRIFT_SAMPLES - 1 - i) % DRIFT_SAMPLES;
+        weighted += (int64_t)m_rates[n] * m_intervals[n];
+        total += m_intervals[n];
+    }
+    m_ppb = weighted / (int64_t)total;
+}
+
+void DriftEstimator::seed(int32_t ppb)
+{
+    reset();
+    m_ppb = ppb;
+}
+
+void DriftEstimator::reset()
+{
+    m_head = 0;
+    m_count = 0;
+    m_ppb = 0;
+    m_interval_s = DRIFT_MIN_INTERVAL_S;
+    m_suspect_s = 0;
+}
@@ -0,0 +1,63 @@
+#include "EffectEngine.h"
+
+bool EffectEngine::select(uint8_t effect, const PanelView &panel)
+{
+    if (effect >= m_count || effect >= MAX_EFFECTS)
+    {
+        return false;
+    }
+    const Effect &next = m_effects[effect];
+    memset(m_arena, 0, next.state_size);
+    if (next.begin && !next.begin(m_arena, panel))
+    {
+        // The arena is the old effect's state, start it over
+        m_ready = false;
+        return false;
+    }
+    m_current = effect;
+    m_ready = true;
+    return true;
+}
+
+void EffectEngine::render(CRGB *leds, const PanelView &panel, const EffectFrame &frame)
+{
+    if (!m_ready && !select(m_current, panel))
+    {
+        return;
+    }
+
+    uint32_t start = micros();
+    m_effects[m_current].render(m_arena, leds, panel, frame);
+    uint32_t elapsed = micros() - start;
+
+    EffectCost &cost = m_costs[m_current];
+    uint16_t us = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+    cost.last_us = us;
+    cost.mean_us = cost.frames ? cost.mean_us + ((int32_t)us - cost.mean_us) / 8 : us;
+    if (us > cost.max_us)
+    {
+        cost.max_us = us;
+    }
+    cost.frames++;
+}
+
+void EffectEngine::dump(Print &out) const
+{
+    for (uint8_t i = 0; i < m_count && i < MAX_EFFECTS; i++)
+    {
+        const EffectCost &cost = m_costs[i];
+        out.print(i == m_current ? "* " : "  ");
+        out.print(i);
+        out.print(' ');
+        out.print(m_effects[i].name);
+        out.print(": ");
+        out.print(cost.frames);
+        out.print(" frames, last ");
+        out.print(cost.last_us);
+        out.print(" us, mean ");
+        out.print(cost.mean_us);
+        out.print(" us, max ");
+        out.print(cost.max_us);
+        out.println(" us");
+    }
+}
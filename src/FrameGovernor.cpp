@@ -0,0 +1,142 @@
+#include "FrameGovernor.h"
+
+// Dithering passes go first, they are most of the load on the device
+// (a show of the whole strip every refresh), then the background rate.
+const GovernorLevel FrameGovernor::levels[GOVERNOR_LEVELS] = {
+    {5, 1},
+    {10, 1},
+    {20, 1},
+    {40, 2},
+    {80, 4},
+};
+
+void FrameGovernor::configure(uint16_t deadline_ms, uint16_t min_ms, uint8_t load_pct)
+{
+    m_deadline_ms = deadline_ms;
+    m_min_ms = min_ms < deadline_ms ? min_ms : deadline_ms;
+    m_load_pct = load_pct;
+    if (!m_frames)
+    {
+        m_level = startLevel();
+    }
+    if (m_period_ms > longestMs() || m_period_ms < m_min_ms)
+    {
+        m_period_ms = longestMs();
+    }
+    m_hold = 0;
+}
+
+void FrameGovernor::frameDone(uint32_t start_ms, uint32_t cost_us)
+{
+    if (m_frames && start_ms - m_last_start_ms > m_deadline_ms)
+    {
+        m_missed++;
+    }
+    m_last_start_ms = start_ms;
+    cost_us = cost_us > m_wire_us ? cost_us : m_wire_us;
+    m_frame_us = m_frames ? m_frame_us + ((int32_t)cost_us - (int32_t)m_frame_us) / 8 : cost_us;
+    m_frames++;
+
+    if (m_hold)
+    {
+        m_hold--;
+        return;
+    }
+    decide();
+}
+
+void FrameGovernor::refreshDone(uint32_t cost_us)
+{
+    cost_us = cost_us > m_wire_us ? cost_us : m_wire_us;
+    m_refresh_us = m_refresh_us ? m_refresh_us + ((int32_t)cost_us - (int32_t)m_refresh_us) / 8 : cost_us;
+}
+
+uint32_t FrameGovernor::loadUs(uint8_t level, uint16_t period_ms) const
+{
+    // One refresh is part of the frame itself
+    uint16_t refreshes = period_ms / levels[level].refresh_ms;
+    return m_frame_us + (refreshes ? refreshes - 1 : 0) * m_refresh_us;
+}
+
+bool FrameGovernor::fits(uint8_t level, uint16_t period_ms) const
+{
+    return loadUs(level, period_ms) <= (uint32_t)period_ms * 10 * m_load_pct;
+}
+
+uint16_t FrameGovernor::longestMs() const
+{
+    uint16_t longest = m_deadline_ms - m_deadline_ms / 8;
+    return longest > m_min_ms ? longest : m_min_ms;
+}
+
+// First level whose refreshes alone fit at the longest period
+//  Before any frame only the refresh cost is known. Starting there saves
+//  stepping down a hold at a time when show() is slow, as a bit-banged one
+//  over the whole strip is.
+uint8_t FrameGovernor::startLevel() const
+{
+    uint16_t longest = longestMs();
+    uint8_t level = 0;
+    while (level < GOVERNOR_LEVELS - 1 &&
+           (uint32_t)(longest / levels[level].refresh_ms) * m_refresh_us > (uint32_t)longest * 10 * m_load_pct)
+    {
+        level++;
+    }
+    return level;
+}
+
+void FrameGovernor::decide()
+{
+    uint16_t longest = longestMs();
+    uint8_t level = m_level;
+    if (!fits(level, longest) && level < GOVERNOR_LEVELS - 1)
+    {
+        level++;
+    }
+    else if (level > 0 && loadUs(level - 1, longest) * 4 < (uint32_t)longest * 10 * m_load_pct * 3)
+    {
+        // Step back up only with a quarter of the budget to spare, the frame
+        // cost was measured at the cheaper level
+        level--;
+    }
+
+    // Fastest period this level fits in
+    uint16_t period = m_min_ms;
+    while (period < longest && !fits(level, period))
+    {
+        period += period / 4 + 1;
+    }
+    if (period > longest)
+    {
+        period = longest;
+    }
+
+    if (level != m_level || period != m_period_ms)
+    {
+        m_level = level;
+        m_period_ms = period;
+        m_hold = GOVERNOR_HOLD_FRAMES;
+    }
+}
+
+void FrameGovernor::dump(Print &out) const
+{
+    out.print("level ");
+    out.print(m_level);
+    out.print(" period ");
+    out.print(m_period_ms);
+    out.print(" ms (deadline ");
+    out.print(m_deadline_ms);
+    out.print(" ms) refresh every ");
+    out.print(refreshMs());
+    out.println(" ms");
+    out.print("frame ");
+    out.print(m_frame_us);
+    out.print(" us, refresh ");
+    out.print(m_refresh_us);
+    out.print(" us, ");
+    out.print(m_missed);
+    out.print(" of ");
+    out.print(m_frames);
+    out.println(" frames missed the deadline");
+}
@@ -0,0 +1,384 @@
+#include "HttpServer.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <strings.h>
+
+static const char *statusText(uint16_t status)
+{
+    switch (status)
+    {
+    case 200:
+        return "OK";
+    case 400:
+        return "Bad Request";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    case 413:
+        return "Payload Too Large";
+    case 414:
+        return "URI Too Long";
+    default:
+        return "Internal Server Error";
+    }
+}
+
+static uint8_t hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    return (c | 0x20) - 'a' + 10;
+}
+
+// Undo form encoding in place, '+' is a space and %XX a byte
+static void urlDecode(char *text)
+{
+    char *out = text;
+    for (char *in = text; *in; in++)
+    {
+        if (*in == '+')
+        {
+            *out++ = ' ';
+        }
+        else if (*in == '%' && isxdigit(in[1]) && isxdigit(in[2]))
+        {
+            *out++ = (hexDigit(in[1]) << 4) | hexDigit(in[2]);
+            in += 2;
+        }
+        else
+        {
+            *out++ = *in;
+        }
+    }
+    *out = '\0';
+}
+
+bool httpFormNext(char *&cursor, char *&name, char *&value)
+{
+    while (*cursor == '&')
+    {
+        cursor++;
+    }
+    if (*cursor == '\0')
+    {
+        return false;
+    }
+    name = cursor;
+    cursor += strcspn(cursor, "&");
+    if (*cursor)
+    {
+        *cursor++ = '\0';
+    }
+    char *equals = strchr(name, '=');
+    if (equals)
+    {
+        *equals = '\0';
+        value = equals + 1;
+    }
+    else
+    {
+        value = name + strlen(name);
+    }
+    urlDecode(name);
+    urlDecode(value);
+    return true;
+}
+
+// JSON
+
+void JsonObject::key(const char *name)
+{
+    if (!m_first)
+    {
+        m_out.print(',');
+    }
+    m_first = false;
+    m_out.print('"');
+    m_out.print(name);
+    m_out.print("\":");
+}
+
+void JsonObject::addInt(const char *name, int32_t value)
+{
+    key(name);
+    m_out.print((long)value);
+}
+
+void JsonObject::addUint(const char *name, uint32_t value)
+{
+    key(name);
+    m_out.print((unsigned long)value);
+}
+
+void JsonObject::addBool(const char *name, bool value)
+{
+    key(name);
+    m_out.print(value ? "true" : "false");
+}
+
+void JsonObject::addText(const char *name, const char *text)
+{
+    key(name);
+    m_out.print('"');
+    for (; *text; text++)
+    {
+        uint8_t c = *text;
+        if (c == '"' || c == '\\')
+        {
+            m_out.print('\\');
+            m_out.print((char)c);
+        }
+        else if (c < 0x20)
+        {
+            const char hex[] = "0123456789abcdef";
+            m_out.print("\\u00");
+            m_out.print(hex[c >> 4]);
+            m_out.print(hex[c & 0xF]);
+        }
+        else
+        {
+            m_out.print((char)c);
+        }
+    }
+    m_out.print('"');
+}
+
+// Server
+
+void HttpServer::poll()
+{
+    if (m_state == HTTP_IDLE)
+    {
+        m_client = m_server.available();
+        if (!m_client)
+        {
+            return;
+        }
+        m_state = HTTP_HEAD;
+        m_start_ms = millis();
+        m_request.method = HTTP_OTHER;
+        m_request.path[0] = '\0';
+        m_request.body_length = 0;
+        m_line_length = 0;
+        m_overflow = false;
+        m_first_line = true;
+        m_status = 0;
+        m_content_length = 0;
+    }
+
+    if (millis() - m_start_ms >= HTTP_TIMEOUT_MS)
+    {
+        close(false);
+        return;
+    }
+    switch (m_state)
+    {
+    case HTTP_HEAD:
+        readHead();
+        break;
+    case HTTP_BODY:
+        readBody();
+        break;
+    case HTTP_WRITE:
+        write();
+        break;
+    default:
+        break;
+    }
+}
+
+void HttpServer::readHead()
+{
+    for (uint8_t i = 0; i < HTTP_READ_PER_POLL && m_client.available(); i++)
+    {
+        int c = m_client.read();
+        if (c < 0)
+        {
+            break;
+        }
+        if (c == '\r')
+        {
+            continue;
+        }
+        if (c != '\n')
+        {
+            if (m_line_length < HTTP_LINE_MAX - 1)
+            {
+                m_line[m_line_length++] = c;
+            }
+            else
+            {
+                m_overflow = true;
+            }
+            continue;
+        }
+
+        m_line[m_line_length] = '\0';
+        bool more = headerLine();
+        m_line_length = 0;
+        m_overflow = false;
+        if (!more)
+        {
+            if (m_content_length && !m_status)
+            {
+                m_state = HTTP_BODY;
+            }
+            else
+            {
+                respond();
+            }
+            return;
+        }
+    }
+    if (!m_client.connected() && !m_client.available())
+    {
+        close(false);
+    }
+}
+
+// Take one line of the head, false at the blank line that ends it
+//  Only the request line and Content-Length matter, other headers are
+//  skipped even when they are too long to hold.
+bool HttpServer::headerLine()
+{
+    if (m_first_line)
+    {
+        m_first_line = false;
+        char *path = strchr(m_line, ' ');
+        if (m_overflow || !path)
+        {
+            m_status = m_overflow ? 414 : 400;
+            return true;
+        }
+        *path++ = '\0';
+        path[strcspn(path, " ?")] = '\0';
+        if (strlen(path) >= HTTP_PATH_MAX)
+        {
+            m_status = 414;
+            return true;
+        }
+        strcpy(m_request.path, path);
+        m_request.method = strcmp(m_line, "GET") == 0 ? HTTP_GET : strcmp(m_line, "POST") == 0 ? HTTP_POST : HTTP_OTHER;
+        return true;
+    }
+    if (m_line_length == 0 && !m_overflow)
+    {
+        return false;
+    }
+    if (!m_overflow && strncasecmp(m_line, "Content-Length:", 15) == 0)
+    {
+        unsigned long length = strtoul(m_line + 15, nullptr, 10);
+        if (length > HTTP_BODY_MAX)
+        {
+            m_status = 413;
+        }
+        else
+        {
+            m_content_length = length;
+        }
+    }
+    return true;
+}
+
+void HttpServer::readBody()
+{
+    uint16_t left = m_content_length - m_request.body_length;
+    int count = m_client.read((uint8_t *)m_request.body + m_request.body_length,
+                              left < HTTP_READ_PER_POLL ? left : HTTP_READ_PER_POLL);
+    if (count > 0)
+    {
+        m_request.body_length += count;
+    }
+    if (m_request.body_length == m_content_length)
+    {
+        m_request.body[m_request.body_length] = '\0';
+        respond();
+    }
+    else if (count <= 0 && !m_client.connected())
+    {
+        close(false);
+    }
+}
+
+// Run the handler, or report why the request was refused, and queue the reply
+void HttpServer::respond()
+{
+    uint16_t status = m_status;
+    uint16_t length = 0;
+    if (!status)
+    {
+        BufferPrint body(m_response, sizeof(m_response));
+        status = m_handler(m_request, body);
+        length = body.overflow() ? 0 : body.length();
+        status = body.overflow() ? 500 : status;
+    }
+    if (status >= 400 && !length)
+    {
+        BufferPrint body(m_response, sizeof(m_response));
+        JsonObject error(body);
+        error.addText("error", statusText(status));
+        error.end();
+        length = body.length();
+    }
+    m_response_length = length;
+
+    BufferPrint header(m_header, sizeof(m_header));
+    header.print("HTTP/1.0 ");
+    header.print(status);
+    header.print(' ');
+    header.print(statusText(status));
+    header.print("\r\nContent-Type: application/json\r\nContent-Length: ");
+    header.print(length);
+    header.print("\r\nConnection: close\r\n\r\n");
+    m_header_length = header.length();
+    m_sent = 0;
+    m_state = HTTP_WRITE;
+}
+
+void HttpServer::write()
+{
+    uint16_t total = m_header_length + m_response_length;
+    const char *data;
+    uint16_t length;
+    if (m_sent < m_header_length)
+    {
+        data = m_header + m_sent;
+        length = m_header_length - m_sent;
+    }
+    else
+    {
+        data = m_response + (m_sent - m_header_length);
+        length = total - m_sent;
+    }
+    if (length > HTTP_WRITE_PER_POLL)
+    {
+        length = HTTP_WRITE_PER_POLL;
+    }
+    m_sent += m_client.write((const uint8_t *)data, length);
+    if (m_sent >= total)
+    {
+        close(true);
+    }
+    else if (!m_client.connected())
+    {
+        close(false);
+    }
+}
+
+void HttpServer::close(bool served)
+{
+    m_client.stop();
+    m_state = HTTP_IDLE;
+    if (served)
+    {
+        m_served++;
+    }
+    else
+    {
+        m_dropped++;
+    }
+}
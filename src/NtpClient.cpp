@@ -0,0 +1,184 @@
+#include "NtpClient.h"
+
+// Seconds from 1900 to 1970, modulo 2^32 this also covers NTP era 1
+#define NTP_UNIX_OFFSET 2208988800UL
+
+static uint32_t readBE32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// NTP timestamp fraction as milliseconds
+static uint32_t fractionToMillis(uint32_t fraction)
+{
+    return ((uint64_t)fraction * 1000) >> 32;
+}
+
+void NtpClient::begin(const char *server, uint16_t port)
+{
+    m_server = server;
+    m_port = port;
+    m_server_ip = IPAddress();
+}
+
+void NtpClient::request()
+{
+    if (m_state == NTP_IDLE)
+    {
+        m_state = NTP_SEND;
+    }
+}
+
+bool NtpClient::poll()
+{
+    uint32_t now = millis();
+    switch (m_state)
+    {
+    case NTP_IDLE:
+        break;
+    case NTP_SEND:
+        send();
+        break;
+    case NTP_WAITING:
+        if (receive())
+        {
+            m_state = NTP_IDLE;
+            m_backoff_ms = NTP_BACKOFF_MIN_MS;
+            m_retrying = false;
+            return true;
+        }
+        if ((now - m_state_ms) >= NTP_TIMEOUT_MS)
+        {
+            fail();
+        }
+        break;
+    case NTP_BACKOFF:
+        if ((now - m_state_ms) >= m_backoff_ms)
+        {
+            m_backoff_ms = m_backoff_ms * 2 > NTP_BACKOFF_MAX_MS ? NTP_BACKOFF_MAX_MS : m_backoff_ms * 2;
+            m_state = NTP_SEND;
+        }
+        break;
+    }
+    return false;
+}
+
+void NtpClient::send()
+{
+    if (!m_started)
+    {
+        m_started = m_udp.begin(NTP_LOCAL_PORT);
+        if (!m_started)
+        {
+            fail();
+            return;
+        }
+    }
+    if (!resolve())
+    {
+        fail();
+        return;
+    }
+    // Drop anything left over from an earlier query
+    while (m_udp.parsePacket() > 0)
+        ;
+
+    uint8_t packet[NTP_PACKET_SIZE] = {};
+    packet[0] = 0b00100011; // LI 0, version 4, mode 3 (client)
+
+    // Random transmit timestamp, the server echoes it back as the origin
+    uint32_t seed = micros() ^ (m_failures << 16);
+    for (uint8_t i = 0; i < sizeof(m_nonce); i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        m_nonce[i] = seed >> 24;
+    }
+    memcpy(packet + 40, m_nonce, sizeof(m_nonce));
+
+    if (!m_udp.beginPacket(m_server_ip, m_port) || m_udp.write(packet, NTP_PACKET_SIZE) != NTP_PACKET_SIZE ||
+        !m_udp.endPacket())
+    {
+        fail();
+        return;
+    }
+    m_state = NTP_WAITING;
+    m_state_ms = millis();
+}
+
+bool NtpClient::receive()
+{
+    if (m_udp.parsePacket() < NTP_PACKET_SIZE)
+    {
+        return false;
+    }
+    uint32_t received_ms = millis();
+    uint8_t packet[NTP_PACKET_SIZE];
+    if (m_udp.read(packet, NTP_PACKET_SIZE) != NTP_PACKET_SIZE || (uint32_t)m_udp.remoteIP() != (uint32_t)m_server_ip)
+    {
+        return false;
+    }
+
+    // Server reply to this query from a synchronised clock
+    uint8_t leap = packet[0] >> 6;
+    uint8_t version = (packet[0] >> 3) & 0x7;
+    uint8_t mode = packet[0] & 0x7;
+    uint8_t stratum = packet[1];
+    if (leap == 3 || version < 3 || mode != 4 || stratum == 0 || stratum > 15 || memcmp(packet + 24, m_nonce, sizeof(m_nonce)) != 0)
+    {
+        return false;
+    }
+    uint32_t receive_s = readBE32(packet + 32);
+    uint32_t transmit_s = readBE32(packet + 40);
+    if (transmit_s == 0)
+    {
+        return false;
+    }
+    uint32_t receive_ms = fractionToMillis(readBE32(packet + 36));
+    uint32_t transmit_ms = fractionToMillis(readBE32(packet + 44));
+
+    // Round trip less the time the server held the request
+    uint32_t round_trip_ms = received_ms - m_state_ms;
+    uint32_t server_ms = (transmit_s - receive_s) * 1000 + transmit_ms - receive_ms;
+    uint32_t delay_ms = round_trip_ms > server_ms ? round_trip_ms - server_ms : 0;
+
+    // Server transmit time plus the return half of the trip
+    uint32_t ms = transmit_ms + delay_ms / 2;
+    m_result.utc = transmit_s - NTP_UNIX_OFFSET + ms / 1000;
+    m_result.utc_ms = ms % 1000;
+    m_result.received_ms = received_ms;
+    m_result.delay_ms = delay_ms;
+    m_result.stratum = stratum;
+    return true;
+}
+
+// Server address for the next query, looked up when there is none yet or
+// queries have failed for NTP_RESOLVE_MS since the last lookup. A failed
+// lookup keeps the previous address.
+bool NtpClient::resolve()
+{
+    uint32_t now = millis();
+    if ((uint32_t)m_server_ip && !(m_retrying && now - m_resolved_ms >= NTP_RESOLVE_MS))
+    {
+        return true;
+    }
+    if (!m_server)
+    {
+        return false;
+    }
+    IPAddress ip;
+    m_resolved_ms = now;
+    m_lookups++;
+    if (m_resolve(m_server, ip) && (uint32_t)ip)
+    {
+        m_server_ip = ip;
+    }
+    return (uint32_t)m_server_ip != 0;
+}
+
+void NtpClient::fail()
+{
+    m_failures++;
+    m_retrying = true;
+    m_state = NTP_BACKOFF;
+    m_state_ms = millis();
+}
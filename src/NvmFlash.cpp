@@ -0,0 +1,91 @@
+#if defined(ARDUINO_ARCH_SAMD)
+
+#include "NvmFlash.h"
+
+// End of the program image, from the linker script
+extern uint32_t __etext;
+extern uint32_t __data_start__;
+extern uint32_t __data_end__;
+
+static uint32_t regionBase()
+{
+    return NVMCTRL->PARAM.bit.NVMP * NVM_FLASH_PAGE - NVM_FLASH_SIZE;
+}
+
+static void waitReady()
+{
+    while (!NVMCTRL->INTFLAG.bit.READY)
+        ;
+}
+
+static bool command(uint32_t cmd)
+{
+    waitReady();
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | cmd;
+    waitReady();
+    return !(NVMCTRL->STATUS.reg & (NVMCTRL_STATUS_PROGE | NVMCTRL_STATUS_LOCKE | NVMCTRL_STATUS_NVME));
+}
+
+bool NvmFlash::begin()
+{
+    // Initialised data is stored after the code
+    uint32_t image_end = (uint32_t)&__etext + ((uint32_t)&__data_end__ - (uint32_t)&__data_start__);
+
+    // Pages are written by command, not when the page buffer fills
+    NVMCTRL->CTRLB.bit.MANW = 1;
+    return image_end <= regionBase();
+}
+
+void NvmFlash::read(uint32_t addr, void *buf, uint32_t len)
+{
+    memcpy(buf, (const void *)(regionBase() + addr), len);
+}
+
+bool NvmFlash::erase(uint32_t addr)
+{
+    if (addr >= NVM_FLASH_SIZE)
+    {
+        return false;
+    }
+    NVMCTRL->STATUS.reg |= NVMCTRL_STATUS_MASK;
+    NVMCTRL->ADDR.reg = (regionBase() + addr) / 2; // 16-bit word address
+    return command(NVMCTRL_CTRLA_CMD_ER);
+}
+
+// Each page goes through the page buffer, which starts all ones after PBC,
+// so the words around the written ones are left as they are
+bool NvmFlash::write(uint32_t addr, const void *data, uint32_t len)
+{
+    if ((addr | len) & 3 || addr + len > NVM_FLASH_SIZE)
+    {
+        return false;
+    }
+    NVMCTRL->STATUS.reg |= NVMCTRL_STATUS_MASK;
+
+    const uint8_t *src = (const uint8_t *)data;
+    volatile uint32_t *dst = (volatile uint32_t *)(regionBase() + addr);
+    while (len)
+    {
+        if (!command(NVMCTRL_CTRLA_CMD_PBC))
+        {
+            return false;
+        }
+        uint32_t page_left = NVM_FLASH_PAGE - ((uint32_t)dst & (NVM_FLASH_PAGE - 1));
+        uint32_t chunk = len < page_left ? len : page_left;
+        for (uint32_t i = 0; i < chunk; i += 4)
+        {
+            uint32_t word;
+            memcpy(&word, src + i, 4); // data need not be aligned
+            *dst++ = word;
+        }
+        if (!command(NVMCTRL_CTRLA_CMD_WP))
+        {
+            return false;
+        }
+        src += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+#endif
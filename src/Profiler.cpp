@@ -0,0 +1,75 @@
+#include "Profiler.h"
+
+static const char *const profileNames[PROFILE_STAGES] = {
+    "sensor", "background", "wordclock", "show", "print", "wifi", "sync"};
+
+static ProfileStats profile[PROFILE_STAGES];
+
+void profileRecord(profile_stage_t stage, uint32_t elapsed_us)
+{
+    ProfileStats &stats = profile[stage];
+    if (stats.count == 0 || elapsed_us < stats.min_us)
+    {
+        stats.min_us = elapsed_us;
+    }
+    if (elapsed_us > stats.max_us)
+    {
+        stats.max_us = elapsed_us;
+    }
+    stats.count++;
+    stats.total_us += elapsed_us;
+
+    // Bucket is the bit length of the time
+    uint8_t bucket = elapsed_us ? 32 - __builtin_clz(elapsed_us) : 0;
+    stats.buckets[bucket < PROFILE_BUCKETS ? bucket : PROFILE_BUCKETS - 1]++;
+}
+
+void profileReset()
+{
+    memset(profile, 0, sizeof(profile));
+}
+
+const ProfileStats &profileStats(profile_stage_t stage)
+{
+    return profile[stage];
+}
+
+// One line per stage:
+//  name count min mean max, then "<limit:count" for each nonzero bucket
+void profileDump(Print &out)
+{
+    out.println("stage count min/mean/max us, histogram <us:count");
+    for (uint8_t i = 0; i < PROFILE_STAGES; i++)
+    {
+        const ProfileStats &stats = profile[i];
+        out.print(profileNames[i]);
+        out.print(" ");
+        out.print(stats.count);
+        out.print(" ");
+        out.print(stats.min_us);
+        out.print("/");
+        out.print(stats.count ? (uint32_t)(stats.total_us / stats.count) : 0);
+        out.print("/");
+        out.print(stats.max_us);
+        for (uint8_t b = 0; b < PROFILE_BUCKETS; b++)
+        {
+            if (stats.buckets[b] == 0)
+            {
+                continue;
+            }
+            if (b == PROFILE_BUCKETS - 1)
+            {
+                out.print(" >=");
+                out.print(1UL << (b - 1));
+            }
+            else
+            {
+                out.print(" <");
+                out.print(1UL << b);
+            }
+            out.print(":");
+            out.print(stats.buckets[b]);
+        }
+        out.println();
+    }
+}
@@ -0,0 +1,164 @@
+#include "RtcDiscipline.h"
+#include "TimeZone.h"
+
+uint32_t readRtcEpoch(RTCZero &rtc)
+{
+#if defined(ARDUINO_ARCH_SAMD)
+    // One read request and clock domain sync, then CLOCK in a single access
+    (void)rtc;
+    RTC->MODE2.READREQ.reg = RTC_READREQ_RREQ;
+    while (RTC->MODE2.STATUS.bit.SYNCBUSY)
+        ;
+    RTC_MODE2_CLOCK_Type clock;
+    clock.reg = RTC->MODE2.CLOCK.reg;
+
+    DateTime utc;
+    utc.year = 2000 + clock.bit.YEAR;
+    utc.month = clock.bit.MONTH;
+    utc.day = clock.bit.DAY;
+    utc.hour = clock.bit.HOUR;
+    utc.minute = clock.bit.MINUTE;
+    utc.second = clock.bit.SECOND;
+    return makeTime(utc);
+#else
+    return rtc.getEpoch();
+#endif
+}
+
+int32_t RtcDiscipline::correctionMs(uint32_t rtc_utc) const
+{
+    if (!m_synced && !m_restored)
+    {
+        return 0;
+    }
+    uint32_t elapsed = rtc_utc - m_anchor_utc;
+    return m_phase_ms - (int32_t)((int64_t)m_sw_ppb * elapsed / 1000000);
+}
+
+uint32_t RtcDiscipline::correct(uint32_t rtc_utc) const
+{
+    int32_t ms = correctionMs(rtc_utc);
+    return rtc_utc + (ms >= 0 ? (ms + 500) / 1000 : -((-ms + 500) / 1000));
+}
+
+void RtcDiscipline::startSync()
+{
+    m_state = RTC_SYNC_EDGE;
+    m_edge_epoch = readRtcEpoch(m_rtc);
+}
+
+void RtcDiscipline::poll()
+{
+    if (m_state == RTC_SYNC_IDLE)
+    {
+        return;
+    }
+    uint32_t epoch = readRtcEpoch(m_rtc);
+    if (epoch == m_edge_epoch)
+    {
+        return;
+    }
+    m_edge_epoch = epoch;
+    m_edge_ms = millis();
+
+    if (m_state == RTC_SYNC_EDGE)
+    {
+        m_state = RTC_SYNC_QUERY;
+    }
+    else if (m_state == RTC_SYNC_PHASE)
+    {
+        // True time at this edge, carried forward from the reply
+        int64_t true_ms = (int64_t)m_result.utc * 1000 + m_result.utc_ms + (uint32_t)(m_edge_ms - m_result.received_ms);
+        int32_t phase_ms = true_ms - (int64_t)epoch * 1000;
+
+        if (m_measured)
+        {
+            m_drift.addSample(m_interval_s, m_offset_ms, m_hw_ppb + m_sw_ppb);
+        }
+        apply(m_drift.ppb());
+        m_anchor_utc = epoch;
+        m_phase_ms = phase_ms;
+        m_state = RTC_SYNC_IDLE;
+    }
+}
+
+void RtcDiscipline::setTime(const NtpResult &result)
+{
+    uint32_t now = millis();
+
+    // Offset at the reply, the RTC reading extrapolated from its last edge
+    m_measured = m_synced && m_state == RTC_SYNC_QUERY;
+    if (m_measured)
+    {
+        m_interval_s = result.utc - m_anchor_utc;
+        int64_t true_ms = (int64_t)result.utc * 1000 + result.utc_ms;
+        int64_t rtc_ms = (int64_t)m_edge_epoch * 1000 + (uint32_t)(result.received_ms - m_edge_ms) + correctionMs(m_edge_epoch);
+        m_offset_ms = true_ms - rtc_ms;
+    }
+
+    uint32_t ms = result.utc_ms + (now - result.received_ms);
+    uint32_t epoch = result.utc + ms / 1000;
+    m_rtc.setEpoch(epoch);
+
+    // Within a second of true time until the phase is measured
+    m_anchor_utc = epoch;
+    m_phase_ms = 0;
+    m_synced = true;
+
+    m_result = result;
+    m_edge_epoch = epoch;
+    m_state = RTC_SYNC_PHASE;
+}
+
+bool RtcDiscipline::restore(const RtcState &state)
+{
+    m_drift.seed(state.drift_ppb);
+    apply(state.drift_ppb);
+    m_restored = true;
+    m_phase_ms = 0;
+    m_anchor_utc = readRtcEpoch(m_rtc);
+    if (m_anchor_utc >= state.utc)
+    {
+        return false;
+    }
+    m_rtc.setEpoch(state.utc);
+    m_anchor_utc = state.utc;
+    return true;
+}
+
+uint8_t rtcFreqCorr(int32_t ppb)
+{
+    int32_t steps = ppb / RTC_FREQCORR_PPB;
+    if (steps > RTC_FREQCORR_MAX)
+    {
+        steps = RTC_FREQCORR_MAX;
+    }
+    if (steps < -RTC_FREQCORR_MAX)
+    {
+        steps = -RTC_FREQCORR_MAX;
+    }
+    // Positive corrections slow the RTC down
+    return steps < 0 ? RTC_FREQCORR_NEGATIVE | -steps : steps;
+}
+
+int32_t rtcFreqCorrPpb(uint8_t freqcorr)
+{
+    int32_t steps = freqcorr & RTC_FREQCORR_MAX;
+    return (freqcorr & RTC_FREQCORR_NEGATIVE ? -steps : steps) * RTC_FREQCORR_PPB;
+}
+
+void RtcDiscipline::apply(int32_t ppb)
+{
+#if defined(ARDUINO_ARCH_SAMD)
+    uint8_t freqcorr = rtcFreqCorr(ppb);
+    while (RTC->MODE2.STATUS.bit.SYNCBUSY)
+        ;
+    RTC->MODE2.FREQCORR.reg = freqcorr;
+    while (RTC->MODE2.STATUS.bit.SYNCBUSY)
+        ;
+#else
+    uint8_t freqcorr = 0; // The host RTC has no FREQCORR, software does it all
+#endif
+    m_hw_ppb = rtcFreqCorrPpb(freqcorr);
+    m_sw_ppb = ppb - m_hw_ppb;
+}
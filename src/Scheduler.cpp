@@ -0,0 +1,78 @@
+#include "Scheduler.h"
+
+int8_t Scheduler::add(const char *name, TaskFunction run, uint32_t period_ms, uint8_t priority)
+{
+    if (m_count >= SCHEDULER_MAX_TASKS)
+    {
+        return -1;
+    }
+    Task &task = m_tasks[m_count];
+    task.name = name;
+    task.run = run;
+    task.period_ms = period_ms;
+    task.priority = priority;
+    task.next_ms = millis();
+    task.max_us = 0;
+    task.runs = 0;
+    task.overruns = 0;
+    return m_count++;
+}
+
+// Whether a task may start now without costing the guarded task its deadline
+bool Scheduler::fits(uint8_t id, uint32_t now) const
+{
+    if (m_guard < 0 || id == m_guard)
+    {
+        return true;
+    }
+    const Task &guarded = m_tasks[m_guard];
+    int32_t slack_ms = (int32_t)(guarded.next_ms - now);
+    return slack_ms >= 0 &&
+           (m_tasks[id].max_us <= (uint32_t)slack_ms * 1000 || (uint32_t)slack_ms * 2 >= guarded.period_ms);
+}
+
+bool Scheduler::runOnce()
+{
+    uint32_t now = millis();
+
+    // Highest priority due task that fits, earliest deadline first on ties.
+    // One that does not fit before the guarded task is passed over, so
+    // shorter tasks behind it still run.
+    int8_t next = -1;
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        const Task &task = m_tasks[i];
+        if ((int32_t)(now - task.next_ms) < 0 || !fits(i, now))
+        {
+            continue;
+        }
+        if (next < 0 || task.priority > m_tasks[next].priority ||
+            (task.priority == m_tasks[next].priority && (int32_t)(task.next_ms - m_tasks[next].next_ms) < 0))
+        {
+            next = i;
+        }
+    }
+    if (next < 0)
+    {
+        return false;
+    }
+    Task &task = m_tasks[next];
+
+    uint32_t start = micros();
+    task.run();
+    uint32_t elapsed = micros() - start;
+
+    if (elapsed > task.max_us)
+    {
+        task.max_us = elapsed;
+    }
+    task.runs++;
+    task.next_ms += task.period_ms;
+    if ((int32_t)(now - task.next_ms) >= 0)
+    {
+        // Missed a whole period, skip ahead rather than running back to back
+        task.overruns++;
+        task.next_ms = now + task.period_ms;
+    }
+    return true;
+}
@@ -0,0 +1,273 @@
+#include "SettingsStore.h"
+
+#define SETTINGS_MAGIC 0x31435357 // "WSC1"
+
+struct SettingsSectorHeader
+{
+    uint32_t magic;
+    uint32_t generation;
+    uint32_t check; // ~generation
+};
+
+struct SettingsRecord
+{
+    uint8_t key;
+    uint8_t len;
+    uint16_t crc; // Over key, len and value
+};
+
+static_assert(sizeof(SettingsSectorHeader) == 12, "Sector header layout");
+static_assert(sizeof(SettingsRecord) == 4, "Records start word aligned");
+
+static uint16_t recordSize(uint8_t len)
+{
+    return sizeof(SettingsRecord) + ((len + 3) & ~3);
+}
+
+// CRC-16/CCITT
+static uint16_t crc16(uint16_t crc, const uint8_t *data, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++)
+    {
+        crc ^= data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t recordCrc(uint8_t key, uint8_t len, const uint8_t *value)
+{
+    uint8_t head[2] = {key, len};
+    return crc16(crc16(0xFFFF, head, 2), value, len);
+}
+
+bool SettingsStore::begin()
+{
+    m_ready = false;
+    m_appends = 0;
+    m_compactions = 0;
+    if (!m_flash.begin())
+    {
+        return false;
+    }
+
+    // Newest valid sector, generations compare by difference
+    bool found = false;
+    for (uint8_t s = 0; s < SETTINGS_SECTORS; s++)
+    {
+        SettingsSectorHeader header;
+        m_flash.read(sectorAddress(s), &header, sizeof(header));
+        if (header.magic == SETTINGS_MAGIC && header.check == ~header.generation &&
+            (!found || (int32_t)(header.generation - m_generation) > 0))
+        {
+            found = true;
+            m_sector = s;
+            m_generation = header.generation;
+        }
+    }
+    if (!found)
+    {
+        return m_ready = format();
+    }
+
+    // One pass over the log, erased flash is the end of it
+    memset(m_offset, 0, sizeof(m_offset));
+    uint32_t base = sectorAddress(m_sector);
+    uint16_t offset = sizeof(SettingsSectorHeader);
+    while (offset + sizeof(SettingsRecord) <= SETTINGS_SECTOR_SIZE)
+    {
+        SettingsRecord record;
+        m_flash.read(base + offset, &record, sizeof(record));
+        if (record.key == 0xFF && record.len == 0xFF && record.crc == 0xFFFF)
+        {
+            break;
+        }
+        if (record.key >= SETTINGS_KEYS || record.len > SETTINGS_VALUE_MAX ||
+            offset + recordSize(record.len) > SETTINGS_SECTOR_SIZE)
+        {
+            // Nothing after this can be trusted, the next write compacts
+            offset = SETTINGS_SECTOR_SIZE;
+            break;
+        }
+        uint8_t value[SETTINGS_VALUE_MAX];
+        m_flash.read(base + offset + sizeof(record), value, record.len);
+        if (recordCrc(record.key, record.len, value) == record.crc)
+        {
+            m_offset[record.key] = offset;
+        }
+        offset += recordSize(record.len);
+    }
+    m_end = offset;
+    return m_ready = true;
+}
+
+uint8_t SettingsStore::read(uint8_t key, void *buf, uint8_t size)
+{
+    if (!m_ready || key >= SETTINGS_KEYS || !m_offset[key])
+    {
+        return 0;
+    }
+    uint32_t address = sectorAddress(m_sector) + m_offset[key];
+    SettingsRecord record;
+    m_flash.read(address, &record, sizeof(record));
+    if (record.len > size)
+    {
+        return 0;
+    }
+    m_flash.read(address + sizeof(record), buf, record.len);
+    return record.len;
+}
+
+bool SettingsStore::write(uint8_t key, const void *data, uint8_t len)
+{
+    if (!m_ready || key >= SETTINGS_KEYS || len > SETTINGS_VALUE_MAX)
+    {
+        return false;
+    }
+    uint8_t current[SETTINGS_VALUE_MAX];
+    if (m_offset[key] && read(key, current, sizeof(current)) == len && memcmp(current, data, len) == 0)
+    {
+        return true;
+    }
+
+    if (m_end + recordSize(len) > SETTINGS_SECTOR_SIZE)
+    {
+        return compact(key, data, len);
+    }
+    uint16_t offset = m_end;
+    if (!append(sectorAddress(m_sector), m_end, key, data, len))
+    {
+        // Part of a record may be there, start afresh on the next write
+        m_end = SETTINGS_SECTOR_SIZE;
+        return false;
+    }
+    m_offset[key] = offset;
+    m_appends++;
+    return true;
+}
+
+void SettingsStore::dump(Print &out)
+{
+    if (!m_ready)
+    {
+        out.println("settings store not available");
+        return;
+    }
+    uint8_t keys = 0;
+    for (uint8_t k = 0; k < SETTINGS_KEYS; k++)
+    {
+        keys += m_offset[k] ? 1 : 0;
+    }
+    out.print("sector ");
+    out.print(m_sector);
+    out.print(" generation ");
+    out.print(m_generation);
+    out.print(", ");
+    out.print(keys);
+    out.print(" keys in ");
+    out.print(m_end);
+    out.print(" of ");
+    out.print(SETTINGS_SECTOR_SIZE);
+    out.println(" bytes");
+    out.print(m_appends);
+    out.print(" appends, ");
+    out.print(m_compactions);
+    out.println(" compactions since boot");
+}
+
+// Empty log in sector 0
+bool SettingsStore::format()
+{
+    for (uint32_t row = 0; row < SETTINGS_SECTOR_SIZE; row += NVM_FLASH_ROW)
+    {
+        if (!m_flash.erase(sectorAddress(0) + row))
+        {
+            return false;
+        }
+    }
+    SettingsSectorHeader header = {SETTINGS_MAGIC, 1, ~(uint32_t)1};
+    if (!m_flash.write(sectorAddress(0), &header, sizeof(header)))
+    {
+        return false;
+    }
+    m_sector = 0;
+    m_generation = 1;
+    m_end = sizeof(header);
+    memset(m_offset, 0, sizeof(m_offset));
+    return true;
+}
+
+// Copy every key's newest value, or the new one for key, into the next
+// sector, then make it active by writing its header
+bool SettingsStore::compact(uint8_t key, const void *data, uint8_t len)
+{
+    uint8_t next = (m_sector + 1) % SETTINGS_SECTORS;
+    uint32_t base = sectorAddress(next);
+    for (uint32_t row = 0; row < SETTINGS_SECTOR_SIZE; row += NVM_FLASH_ROW)
+    {
+        if (!m_flash.erase(base + row))
+        {
+            return false;
+        }
+    }
+
+    uint16_t end = sizeof(SettingsSectorHeader);
+    uint16_t offset[SETTINGS_KEYS] = {};
+    for (uint8_t k = 0; k < SETTINGS_KEYS; k++)
+    {
+        uint8_t value[SETTINGS_VALUE_MAX];
+        const void *source = value;
+        uint8_t length;
+        if (k == key)
+        {
+            source = data;
+            length = len;
+        }
+        else if (m_offset[k])
+        {
+            length = read(k, value, sizeof(value));
+        }
+        else
+        {
+            continue;
+        }
+        offset[k] = end;
+        if (!append(base, end, k, source, length))
+        {
+            return false;
+        }
+    }
+
+    uint32_t generation = m_generation + 1;
+    SettingsSectorHeader header = {SETTINGS_MAGIC, generation, ~generation};
+    if (!m_flash.write(base, &header, sizeof(header)))
+    {
+        return false;
+    }
+    m_sector = next;
+    m_generation = generation;
+    m_end = end;
+    memcpy(m_offset, offset, sizeof(m_offset));
+    m_appends++;
+    m_compactions++;
+    return true;
+}
+
+bool SettingsStore::append(uint32_t sector, uint16_t &end, uint8_t key, const void *data, uint8_t len)
+{
+    uint8_t buf[sizeof(SettingsRecord) + SETTINGS_VALUE_MAX + 3];
+    SettingsRecord record = {key, len, recordCrc(key, len, (const uint8_t *)data)};
+    uint16_t size = recordSize(len);
+    memcpy(buf, &record, sizeof(record));
+    memcpy(buf + sizeof(record), data, len);
+    memset(buf + sizeof(record) + len, 0xFF, size - sizeof(record) - len);
+    if (!m_flash.write(sector + end, buf, size))
+    {
+        return false;
+    }
+    end += size;
+    return true;
+}
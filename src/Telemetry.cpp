@@ -0,0 +1,92 @@
+#include "Telemetry.h"
+
+#define TELEMETRY_MASK (TELEMETRY_BUFFER_SIZE - 1)
+
+static_assert((TELEMETRY_BUFFER_SIZE & TELEMETRY_MASK) == 0, "TELEMETRY_BUFFER_SIZE must be a power of two");
+
+bool Telemetry::send(telemetry_type_t type, const void *payload, uint8_t length)
+{
+    if (length > TELEMETRY_MAX_PAYLOAD)
+    {
+        length = TELEMETRY_MAX_PAYLOAD;
+    }
+
+    // One byte stays free so a full ring is told apart from an empty one
+    uint16_t head = m_head;
+    uint16_t tail = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+    uint16_t free_bytes = (tail - head - 1) & TELEMETRY_MASK;
+    if (free_bytes < TELEMETRY_HEADER_SIZE + length + 1)
+    {
+        m_dropped++;
+        return false;
+    }
+
+    uint32_t now = millis();
+    uint8_t header[TELEMETRY_HEADER_SIZE] = {
+        TELEMETRY_MAGIC, TELEMETRY_VERSION, (uint8_t)type, length,
+        (uint8_t)now, (uint8_t)(now >> 8), (uint8_t)(now >> 16), (uint8_t)(now >> 24)};
+    uint8_t crc = telemetryCrc(0, header + 1, TELEMETRY_HEADER_SIZE - 1);
+    crc = telemetryCrc(crc, (const uint8_t *)payload, length);
+
+    for (uint8_t i = 0; i < TELEMETRY_HEADER_SIZE; i++)
+    {
+        m_buffer[head] = header[i];
+        head = (head + 1) & TELEMETRY_MASK;
+    }
+    for (uint8_t i = 0; i < length; i++)
+    {
+        m_buffer[head] = ((const uint8_t *)payload)[i];
+        head = (head + 1) & TELEMETRY_MASK;
+    }
+    m_buffer[head] = crc;
+    head = (head + 1) & TELEMETRY_MASK;
+
+    // Publish the record only once all of it is written
+    __atomic_store_n(&m_head, head, __ATOMIC_RELEASE);
+    m_sent++;
+    return true;
+}
+
+void Telemetry::drain()
+{
+    uint16_t tail = m_tail;
+    uint16_t head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+    int room = m_out.availableForWrite();
+    while (room > 0 && tail != head)
+    {
+        // Up to the end of the data or the end of the buffer, whichever is first
+        uint16_t length = head > tail ? head - tail : TELEMETRY_BUFFER_SIZE - tail;
+        if (length > (uint16_t)room)
+        {
+            length = room;
+        }
+        length = m_out.write(m_buffer + tail, length);
+        if (length == 0)
+        {
+            break;
+        }
+        tail = (tail + length) & TELEMETRY_MASK;
+        room -= length;
+    }
+    __atomic_store_n(&m_tail, tail, __ATOMIC_RELEASE);
+}
+
+size_t Telemetry::write(uint8_t c)
+{
+    m_line[m_line_length++] = c;
+    if (c == '\n' || m_line_length == TELEMETRY_MAX_PAYLOAD)
+    {
+        flush();
+    }
+    return 1;
+}
+
+// Send the pending text
+void Telemetry::flush()
+{
+    if (m_line_length)
+    {
+        send(TELEMETRY_TEXT, m_line, m_line_length);
+        m_line_length = 0;
+    }
+}
@@ -0,0 +1,9 @@
+#include "TimeSnapshot.h"
+
+void readTimeSnapshot(RtcDiscipline &clock, TimeZone &tz, TimeSnapshot &snapshot)
+{
+    snapshot.utc = clock.now();
+    snapshot.dst = tz.isDST(snapshot.utc);
+    snapshot.local = tz.toLocal(snapshot.utc);
+    breakTime(snapshot.local, snapshot.time);
+}
@@ -0,0 +1,215 @@
+#include "TimeZone.h"
+
+uint32_t daysFromCivil(uint16_t year, uint8_t month, uint8_t day)
+{
+    // Count from 0000-03-01 so the leap day is the last day of the year
+    uint32_t y = year - (month <= 2 ? 1 : 0);
+    uint32_t era = y / 400;
+    uint32_t yoe = y - era * 400;
+    uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void breakTime(uint32_t epoch, DateTime &time)
+{
+    uint32_t days = epoch / SECONDS_PER_DAY;
+    uint32_t seconds = epoch % SECONDS_PER_DAY;
+    time.hour = seconds / 3600;
+    time.minute = (seconds / 60) % 60;
+    time.second = seconds % 60;
+    time.weekday = (days + 4) % 7; // 1970-01-01 was a Thursday
+
+    uint32_t z = days + 719468;
+    uint32_t era = z / 146097;
+    uint32_t doe = z - era * 146097;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    time.day = doy - (153 * mp + 2) / 5 + 1;
+    time.month = mp < 10 ? mp + 3 : mp - 9;
+    time.year = yoe + era * 400 + (time.month <= 2 ? 1 : 0);
+}
+
+uint32_t makeTime(const DateTime &time)
+{
+    return daysFromCivil(time.year, time.month, time.day) * SECONDS_PER_DAY + time.hour * 3600UL + time.minute * 60 + time.second;
+}
+
+// Rule parsing
+
+static bool isAlpha(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static const char *parseName(const char *p)
+{
+    if (*p == '<')
+    {
+        while (*p && *p != '>')
+        {
+            p++;
+        }
+        return *p == '>' ? p + 1 : nullptr;
+    }
+    const char *start = p;
+    while (isAlpha(*p))
+    {
+        p++;
+    }
+    return (p - start) >= 3 ? p : nullptr;
+}
+
+static const char *parseNumber(const char *p, int32_t &value)
+{
+    if (!isDigit(*p))
+    {
+        return nullptr;
+    }
+    value = 0;
+    while (isDigit(*p))
+    {
+        value = value * 10 + (*p++ - '0');
+    }
+    return p;
+}
+
+// [+-]hh[:mm[:ss]] as seconds
+static const char *parseTime(const char *p, int32_t &seconds)
+{
+    int32_t sign = 1;
+    if (*p == '+' || *p == '-')
+    {
+        sign = (*p++ == '-') ? -1 : 1;
+    }
+    int32_t value;
+    if (!(p = parseNumber(p, value)))
+    {
+        return nullptr;
+    }
+    seconds = value * 3600;
+    for (int32_t scale = 60; *p == ':' && scale >= 1; scale /= 60)
+    {
+        if (!(p = parseNumber(p + 1, value)))
+        {
+            return nullptr;
+        }
+        seconds += value * scale;
+    }
+    seconds *= sign;
+    return p;
+}
+
+// ,Mm.w.d[/time]
+static const char *parseTransition(const char *p, uint8_t &month, uint8_t &week, uint8_t &weekday, int32_t &time)
+{
+    int32_t m, w, d;
+    if (*p++ != ',' || *p++ != 'M')
+    {
+        return nullptr;
+    }
+    if (!(p = parseNumber(p, m)) || *p++ != '.' || !(p = parseNumber(p, w)) || *p++ != '.' || !(p = parseNumber(p, d)))
+    {
+        return nullptr;
+    }
+    if (m < 1 || m > 12 || w < 1 || w > 5 || d > 6)
+    {
+        return nullptr;
+    }
+    month = m;
+    week = w;
+    weekday = d;
+    time = 2 * 3600;
+    if (*p == '/' && !(p = parseTime(p + 1, time)))
+    {
+        return nullptr;
+    }
+    return p;
+}
+
+bool TimeZone::begin(const char *rule)
+{
+    m_std_offset = 0;
+    m_dst_offset = 0;
+    m_has_dst = false;
+    m_year_start = 1;
+    m_year_end = 0;
+
+    // POSIX offsets are west of UTC, store them east
+    int32_t std_offset, dst_offset;
+    const char *p = parseName(rule);
+    if (!p || !(p = parseTime(p, std_offset)))
+    {
+        return false;
+    }
+    if (!*p)
+    {
+        m_std_offset = -std_offset;
+        m_dst_offset = m_std_offset;
+        return true;
+    }
+
+    if (!(p = parseName(p)))
+    {
+        return false;
+    }
+    dst_offset = std_offset - 3600;
+    if (*p && *p != ',' && !(p = parseTime(p, dst_offset)))
+    {
+        return false;
+    }
+    Transition start, end;
+    if (!(p = parseTransition(p, start.month, start.week, start.weekday, start.time)) ||
+        !(p = parseTransition(p, end.month, end.week, end.weekday, end.time)) || *p)
+    {
+        return false;
+    }
+
+    m_std_offset = -std_offset;
+    m_dst_offset = -dst_offset;
+    m_start = start;
+    m_end = end;
+    m_has_dst = true;
+    return true;
+}
+
+// Local epoch of a transition in the given year
+uint32_t TimeZone::transitionLocal(uint16_t year, const Transition &transition) const
+{
+    static const uint8_t days_in_month[12] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    uint8_t month_days = days_in_month[transition.month - 1];
+    if (transition.month == 2 && !((year % 4 == 0 && year % 100 != 0) || year % 400 == 0))
+    {
+        month_days = 28;
+    }
+
+    uint32_t first = daysFromCivil(year, transition.month, 1);
+    uint8_t first_weekday = (first + 4) % 7;
+    uint8_t day = 1 + (transition.weekday + 7 - first_weekday) % 7 + (transition.week - 1) * 7;
+    while (day > month_days)
+    {
+        day -= 7;
+    }
+    return (first + day - 1) * SECONDS_PER_DAY + transition.time;
+}
+
+void TimeZone::updateYear(uint32_t utc)
+{
+    DateTime local;
+    breakTime(utc + m_std_offset, local);
+
+    m_year_start = daysFromCivil(local.year, 1, 1) * SECONDS_PER_DAY - m_std_offset;
+    m_year_end = daysFromCivil(local.year + 1, 1, 1) * SECONDS_PER_DAY - m_std_offset;
+    if (m_has_dst)
+    {
+        // Start is given in standard time, end in DST
+        m_dst_start = transitionLocal(local.year, m_start) - m_std_offset;
+        m_dst_end = transitionLocal(local.year, m_end) - m_dst_offset;
+    }
+}
@@ -0,0 +1,120 @@
+#include "Transition.h"
+
+// Smoothstep, 0..255 over TRANSITION_EASE_STEPS
+static const uint8_t easeInOut[TRANSITION_EASE_STEPS + 1] = {
+    0, 0, 1, 2, 3, 4, 6, 8, 11, 14, 17, 20, 24, 27, 31, 35, 40, 44, 49, 54, 59, 64,
+    70, 75, 81, 86, 92, 98, 104, 110, 116, 122, 128, 133, 139, 145, 151, 157, 163, 169, 174, 180,
+    185, 191, 196, 201, 206, 211, 215, 220, 224, 228, 231, 235, 238, 241, 244, 247, 249, 251, 252, 253,
+    254, 255, 255};
+
+void Transition::configure(transition_style_t style, uint8_t frames)
+{
+    m_style = style < TRANSITION_STYLES ? style : TRANSITION_CROSSFADE;
+    m_frames_config = frames ? frames : 1;
+}
+
+void Transition::start(const LedMask &from, const LedMask &to)
+{
+    uint8_t frames = m_style == TRANSITION_CUT ? 1 : m_frames_config;
+
+    // Fade length per LED
+    switch (m_style)
+    {
+    case TRANSITION_CROSSFADE:
+        m_ramp = frames;
+        break;
+    case TRANSITION_WIPE:
+    case TRANSITION_TYPEWRITER:
+        m_ramp = frames / 4;
+        break;
+    default:
+        m_ramp = 1;
+        break;
+    }
+    if (m_ramp == 0)
+    {
+        m_ramp = 1;
+    }
+    m_ease_step = (TRANSITION_EASE_STEPS << 8) / m_ramp;
+
+    // Count the letters coming on, the typewriter spreads them over what is left
+    uint8_t incoming = 0;
+    for (uint8_t i = 0; i < LED_MASK_WORDS; i++)
+    {
+        incoming += __builtin_popcount(to.bits[i] & ~from.bits[i]);
+    }
+    uint8_t typed = 0;
+    uint8_t typing = frames > m_ramp + 1 ? frames - m_ramp - 1 : 0; // Frames between the first and last letter
+
+    // Reading order, so the wipe and typewriter run the way the words read
+    m_count = 0;
+    for (uint8_t y = 0; y < WC_Y; y++)
+    {
+        for (uint8_t x = 0; x < WC_X; x++)
+        {
+            uint8_t led = ledMap[y][x];
+            bool was_on = from.test(led);
+            bool is_on = to.test(led);
+            if (!was_on && !is_on)
+            {
+                continue;
+            }
+
+            Fade &fade = m_fades[m_count++];
+            fade.led = led;
+            fade.kind = was_on && is_on ? FADE_STEADY : (is_on ? FADE_IN : FADE_OUT);
+            fade.start = 0;
+            if (m_style == TRANSITION_WIPE)
+            {
+                fade.start = x * (frames - m_ramp) / (WC_X - 1);
+            }
+            else if (m_style == TRANSITION_TYPEWRITER && fade.kind == FADE_IN)
+            {
+                // Letters snap on one after another once the old words are gone
+                fade.start = m_ramp + typed++ * typing / (incoming > 1 ? incoming - 1 : 1);
+            }
+        }
+    }
+    m_frame = 0;
+    m_frames = frames;
+}
+
+void Transition::composite(CRGB *leds)
+{
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        const Fade &fade = m_fades[i];
+        uint8_t level = 255;
+        if (fade.kind != FADE_STEADY)
+        {
+            // Typewriter letters come on in one frame, others follow the easing table
+            bool snap = m_style == TRANSITION_TYPEWRITER && fade.kind == FADE_IN;
+            uint8_t ramp = snap ? 1 : m_ramp;
+            uint16_t step = snap ? TRANSITION_EASE_STEPS << 8 : m_ease_step;
+            uint8_t eased;
+            if (m_frame < fade.start)
+            {
+                eased = 0;
+            }
+            else if (m_frame - fade.start >= ramp)
+            {
+                eased = 255;
+            }
+            else
+            {
+                eased = easeInOut[((m_frame - fade.start + 1) * step) >> 8];
+            }
+            level = fade.kind == FADE_IN ? eased : 255 - eased;
+        }
+
+        // Blend towards white by level
+        CRGB &led = leds[fade.led];
+        led.r += ((255 - led.r) * (level + 1)) >> 8;
+        led.g += ((255 - led.g) * (level + 1)) >> 8;
+        led.b += ((255 - led.b) * (level + 1)) >> 8;
+    }
+    if (m_frame < m_frames)
+    {
+        m_frame++;
+    }
+}
@@ -0,0 +1,52 @@
+#include "WS2812Encoder.h"
+
+#include <string.h>
+
+// SPI bytes for every colour byte, MSB first
+struct WS2812Pattern
+{
+    uint8_t bytes[256][3];
+
+    constexpr WS2812Pattern() : bytes()
+    {
+        for (uint16_t value = 0; value < 256; value++)
+        {
+            uint32_t pattern = 0;
+            for (int8_t bit = 7; bit >= 0; bit--)
+            {
+                pattern = (pattern << 3) | (((value >> bit) & 1) ? 0b110 : 0b100);
+            }
+            bytes[value][0] = pattern >> 16;
+            bytes[value][1] = pattern >> 8;
+            bytes[value][2] = pattern;
+        }
+    }
+};
+
+static constexpr WS2812Pattern ws2812Pattern;
+
+static inline uint8_t *encodeByte(uint8_t *out, uint8_t value, uint8_t scale)
+{
+    const uint8_t *pattern = ws2812Pattern.bytes[(value * (scale + 1)) >> 8];
+    out[0] = pattern[0];
+    out[1] = pattern[1];
+    out[2] = pattern[2];
+    return out + 3;
+}
+
+void ws2812Encode(const uint8_t *rgb, uint16_t count, const uint8_t scale[3], uint8_t *out)
+{
+    for (uint16_t i = 0; i < count; i++, rgb += 3)
+    {
+        out = encodeByte(out, rgb[1], scale[1]);
+        out = encodeByte(out, rgb[0], scale[0]);
+        out = encodeByte(out, rgb[2], scale[2]);
+    }
+}
+
+uint16_t ws2812Reset(uint8_t *out, uint16_t count)
+{
+    uint16_t len = count * WS2812_BYTES_PER_PIXEL;
+    memset(out + len, 0, WS2812_RESET_BYTES);
+    return len + WS2812_RESET_BYTES;
+}
@@ -0,0 +1,70 @@
+#include "WordLayer.h"
+
+bool WordLayer::update(uint8_t hour, uint8_t slot)
+{
+    uint16_t key = (hour << 4) | slot;
+    if (key == m_key)
+    {
+        return false;
+    }
+    m_key = key;
+
+    const LedMask &mask = phraseMask.phrase[hour % 12][slot];
+    if (mask == m_mask)
+    {
+        return false;
+    }
+    LedMask from = m_mask;
+    m_mask = mask;
+
+    // Cache the lit LEDs so compositing is a straight copy
+    m_count = 0;
+    for (uint8_t i = 0; i < LED_MASK_WORDS; i++)
+    {
+        uint32_t bits = m_mask.bits[i];
+        while (bits)
+        {
+            m_leds[m_count++] = i * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+        }
+    }
+
+    for (uint8_t i = 0; i < WORD_LAYER_LISTENERS; i++)
+    {
+        if (m_listeners[i])
+        {
+            m_listeners[i](from, m_mask);
+        }
+    }
+    return true;
+}
+
+void WordLayer::composite(CRGB *leds) const
+{
+    for (uint16_t i = 0; i < m_count; i++)
+    {
+        leds[m_leds[i]].setRGB(255, 255, 255);
+    }
+}
+
+void WordLayer::tint(CRGB *leds, const CRGB &tint) const
+{
+    for (uint16_t i = 0; i < m_count; i++)
+    {
+        CRGB &led = leds[m_leds[i]];
+        led.setRGB(scale8(led.r, tint.r), scale8(led.g, tint.g), scale8(led.b, tint.b));
+    }
+}
+
+bool WordLayer::onChanged(WordLayerChanged listener)
+{
+    for (uint8_t i = 0; i < WORD_LAYER_LISTENERS; i++)
+    {
+        if (!m_listeners[i])
+        {
+            m_listeners[i] = listener;
+            return true;
+        }
+    }
+    return false;
+}
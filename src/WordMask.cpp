@@ -0,0 +1,5 @@
+#include "WordMask.h"
+
+// Generated at compile time, stored in flash
+constexpr WordMaskTable wordMask;
+constexpr PhraseMaskTable phraseMask;
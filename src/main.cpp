@@ -4,132 +4,258 @@
 #include <RTCZero.h>
 #include <WiFiNINA.h>
 
+#include "AmbientSensor.h"
+#include "Background.h"
+#include "BrightnessFilter.h"
+#include "Console.h"
+#include "DmaWS2812Controller.h"
+#include "EffectEngine.h"
+#include "FrameGovernor.h"
+#include "HttpServer.h"
+#include "NtpClient.h"
+#include "Profiler.h"
+#include "RtcDiscipline.h"
+#include "Scheduler.h"
+#include "SettingsStore.h"
+#include "Telemetry.h"
+#include "TemporalDither.h"
+#include "TimeSnapshot.h"
+#include "TimeZone.h"
+#include "Transition.h"
+#include "WordLayer.h"
+#include "WordMask.h"
+
+#if __has_include("WiFiCredentials.h")
 #include "WiFiCredentials.h"
+#elif defined(WORDCLOCK_NATIVE)
+#define WIFI_SSID "native" // The host network stands in for WiFi
+#define WIFI_PASS ""
+#else
+#error "Create include/WiFiCredentials.h defining WIFI_SSID and WIFI_PASS"
+#endif
+
 #define SENSOR_PIN A0
 #define LED_PIN 13
-#define NUM_LEDS 1000 // Use large number to avoid flickering with dithering
+#define NUM_LEDS WC_LEDS
+
+// #define BENCHMARK_BACKGROUND // Time background kernels at startup
+// #define WS2812_DMA           // Send LED data by SPI DMA on D11 (MOSI) instead of bit-banging LED_PIN
 
 #define MIN(X, Y) (((X) < (Y)) ? (X) : (Y))
 #define MAX(X, Y) (((X) > (Y)) ? (X) : (Y))
 
+#if defined(ARDUINO_ARCH_SAMD)
+extern "C" char *sbrk(int incr); // Heap end, for freeRam()
+#endif
+
+// Scheduler
+Scheduler scheduler;
+const uint32_t MILLIS_SENSOR = 50;       // Time in milliseconds between brightness samples
+const uint32_t MILLIS_WIFI_CHECK = 1000; // Time in milliseconds between WiFi/RTC update checks
+const uint32_t MILLIS_WIFI_CHECK_BOOT = 100; // Time in milliseconds between WiFi checks until the first sync
+const uint32_t MILLIS_NTP_POLL = 20;     // Time in milliseconds between NTP client steps
+const uint32_t MILLIS_TELEMETRY = 10;    // Time in milliseconds between telemetry drains
+const uint32_t MILLIS_CONSOLE = 20;      // Time in milliseconds between console input checks
+int8_t render_task = -1;
+int8_t refresh_task = -1;
+int8_t wifi_task = -1;
+
 // Word Clock
-//  LEDs:
-//  119 118 ... 109 108
-//  96  97  ... 106 107
-//  95  94  ... 85  84
-//  72  73  ... 82  83
-//  71  70  ... 61  60
-//  48  49  ... 58  59
-//  47  46  ... 37  36
-//  24  25  ... 34  35
-//  23  22  ... 13  12
-//  11  10  ... 1   0
-//
-//  Index:
-//  [0,0] -> [11,0]
-//  [0,1] -> [11,1]
-//  [0,2] -> [11,2]
-//  [0,3] -> [11,3]
-//  [0,4] -> [11,4]
-//  [0,5] -> [11,5]
-//  [0,6] -> [11,6]
-//  [0,7] -> [11,7]
-//  [0,8] -> [11,8]
-//  [0,9] -> [11,9]
-//
-//  Layout:
-// I T T I S I M H A L F E
-// A Q U A R T E R N T E N
-// T W E N T Y D F I V E D
-// P A S T A T O T E O N E
-// T W E L V E T I M T W O
-// A T H R E E E N F O U R
-// F I V E S I X D N I N E
-// S E V E N D A E I G H T
-// T E N T E L E V E N E T
-// I M O ' C L O C K E A N
-
-// IT IS [HALF,QUARTER,TEN,TWENTY,FIVE] [PAST,TO] [ONE,TWELVE,TWO,THREE,FOUR,FIVE,SIX,NINE,SEVEN,EIGHT,TEN,ELEVEN] O'CLOCK
-#define WC_X 12
-#define WC_Y 10
-const uint32_t MILLIS_UPDATE_WC = 100;
-uint64_t millis_wc_update = 0; // Time in milliseconds from when the led strip was last updated
-CRGB leds[NUM_LEDS];
+const uint32_t MILLIS_FRAME_DEADLINE = 100; // Time in milliseconds a frame may take to come round
+const uint32_t MILLIS_FRAME_MIN = 20;       // Time in milliseconds between frames at the fastest
+const uint32_t MILLIS_ANIM_STEP = 100;      // Time in milliseconds per animation step at anim_speed 1
+uint16_t frame_deadline_ms = MILLIS_FRAME_DEADLINE; // Settable from the console
+uint8_t frame_load = 50;                    // Percent of each frame period rendering may use
+uint8_t anim_speed = 1;                     // Background animation steps per MILLIS_ANIM_STEP
+uint16_t anim_remainder = 0;                // Part step carried to the next background
+FrameGovernor governor;                     // Frame and refresh periods, quality level
+CRGB background[NUM_LEDS];                  // Last rendered background, reused when the governor skips one
+CRGB leds[NUM_LEDS];                        // Rendered frame, reused as the dithered output
+TemporalDither<NUM_LEDS> dither;
+#ifdef WS2812_DMA
+DmaWS2812Controller<NUM_LEDS> ledController;
+#else
+// Bit-banged show() runs with interrupts off and micros() can miss ticks
+//  during it, so the governor is told the wire time: 30 us per LED plus
+//  the reset
+const uint32_t MICROS_SHOW_WIRE = NUM_LEDS * 30 + 280; // Time in microseconds one show() holds the CPU
+#endif
 uint32_t ledNdx = 0;
 uint8_t rgbw = 0;
 
-uint8_t ledMap[WC_Y][WC_X] = {
-    {119, 118, 117, 116, 115, 114, 113, 112, 111, 110, 109, 108},
-    {96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107},
-    {95, 94, 93, 92, 91, 90, 89, 88, 87, 86, 85, 84},
-    {72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83},
-    {71, 70, 69, 68, 67, 66, 65, 64, 63, 62, 61, 60},
-    {48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59},
-    {47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36},
-    {24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35},
-    {23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12},
-    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}};
-
-uint8_t ledNoise[WC_Y][WC_X];
-
-bool wordMask[22];
-enum word_t
-{
-    WC_IT,
-    WC_IS,
-    WC_A,
-    WC_HALF,
-    WC_QUARTER,
-    WC_TEN,
-    WC_TWENTY,
-    WC_FIVE,
-    WC_PAST,
-    WC_TO,
-    WC_HOUR_ONE,
-    WC_HOUR_TWO,
-    WC_HOUR_THREE,
-    WC_HOUR_FOUR,
-    WC_HOUR_FIVE,
-    WC_HOUR_SIX,
-    WC_HOUR_NINE,
-    WC_HOUR_SEVEN,
-    WC_HOUR_EIGHT,
-    WC_HOUR_TEN,
-    WC_HOUR_ELEVEN,
-    WC_HOUR_TWELVE,
-    WC_OCLOCK
-};
+EffectEngine effects(backgroundEffects, EFFECTS);
+uint8_t effect = EFFECT_RAINBOW; // background_effect_t, settable from the console
+uint8_t effect_hue = 160;        // Base colour of the effects that use one
+WordLayer wordLayer;
+Transition transition;
+uint8_t transition_style = TRANSITION_CROSSFADE; // transition_style_t, settable from the console
+uint8_t transition_frames = 10;                  // Frames a phrase change takes
 
 // LED Strip
 
+// Brightness
+//  Ambient level from the free-running ADC, filtered then mapped perceptually
+AmbientSensor ambient;
+BrightnessFilter brightnessFilter;
+uint8_t min_brightness = 10;
+uint8_t brightness = 255;
+const uint8_t TELEMETRY_BRIGHTNESS_STEP = 8; // Change in brightness that is reported
+uint8_t reported_brightness = 0;
+
 // RTC
+//  Holds UTC, local time comes from the timezone rule
 RTCZero rtc;
-const int8_t GMT = -5; // EST
-uint8_t rtc_set = 0;
-uint64_t millis_rtc_update = 0; // Time in milliseconds when RTC was updated
+RtcDiscipline discipline(rtc); // Drift correction between syncs
+char tz_rule[48] = "EST5EDT,M3.2.0,M11.1.0"; // US Eastern, POSIX TZ format
+TimeZone tz;
+TimeSnapshot timeNow; // Read once per frame
+uint32_t millis_rtc_update = 0; // Time in milliseconds when RTC was updated
 
 // WIFI
 char ssid[] = WIFI_SSID;                            // Set SSID from WiFiCredentials.h
 char pass[] = WIFI_PASS;                            // Set SSID from WiFiCredentials.h
-const uint32_t MILLIS_WIFI_REFRESH = 3600000;       // Time in milliseconds to refresh epoch from wifi
 const uint32_t MILLIS_WIFI_CONNECTION_WAIT = 10000; // Time in milliseconds to wait after starting wifi connection
-uint64_t millis_wifi_start_connection = 0;          // Time in milliseconds from when WiFi connection attempt started
+uint32_t millis_wifi_start_connection = 0;          // Time in milliseconds from when WiFi connection attempt started
+
+// NTP
+char ntp_server[48] = "pool.ntp.org"; // Settable from the console
+WiFiUDP ntpUdp;
+int resolveHost(const char *host, IPAddress &ip);
+NtpClient ntp(ntpUdp, resolveHost);
+
+// Telemetry
+//  Binary records on Serial, decode with tools/telemetry_decode.cpp
+Telemetry telemetry(Serial);
+const uint32_t MILLIS_PRINTOUT_TIME = 60000; // Time in milliseconds between time and frame stats records
+
+// Settings
+//  The console parameters in storedParams survive a reset, kept in a log at
+//  the top of flash. A change is written once it has stood for
+//  MILLIS_SETTINGS_SETTLE, and at most once per MILLIS_SETTINGS_WRITE, so
+//  tweaking from the console cannot wear the flash out.
+NvmFlash flash;
+SettingsStore settings(flash);
+const uint32_t MILLIS_SETTINGS_CHECK = 1000;  // Time in milliseconds between checks for changed settings
+const uint32_t MILLIS_SETTINGS_SETTLE = 5000; // Time in milliseconds a change has to stand before it is written
+const uint32_t MILLIS_SETTINGS_WRITE = 60000; // Time in milliseconds between settings writes at least
+uint32_t millis_settings_changed = 0;         // Time in milliseconds of the last stored parameter change
+uint32_t millis_settings_write = 0;           // Time in milliseconds of the last settings write
+bool settings_dirty = false;
 
-// Printouts
-const uint32_t MILLIS_PRINTOUT_TIME = 60000; // Time in milliseconds between time print out
-uint64_t millis_time_printout = 0;           // Time in milliseconds from when the time was last printed out
+// Boot
+//  The last good time and drift are kept in the settings store, so the
+//  first frame already shows a close time. The words are tinted until an
+//  NTP sync confirms it. Each milestone is timed from boot.
+const uint8_t SETTINGS_KEY_CLOCK = 15;       // RtcState, not a console parameter
+const uint32_t MILLIS_CLOCK_SAVE = 300000;   // Time in milliseconds between saves of the synced time
+const CRGB UNVERIFIED_TINT = CRGB(255, 96, 16); // Word colour while the time is unverified, amber
+uint32_t millis_clock_save = 0;              // Time in milliseconds when the time was saved
+TelemetryBoot boot = {};
+bool boot_first_frame = false;
+bool boot_reported = false;
 
 
-void updateWC();
-void setWCWord(word_t word);
-void setRTCFromWiFi();
-uint32_t isDST();
-uint32_t dayOfWeek();
-void printTime();
-void printDate();
+void renderTask();
+void refreshTask();
+void sensorTask();
+void wifiTask();
+void ntpTask();
+void printTask();
+void telemetryTask();
+void consoleTask();
+void httpTask();
+void settingsTask();
+void updateBackground();
+#ifdef BENCHMARK_BACKGROUND
+void updateBackgroundFloat(uint32_t step);
+void benchmarkBackground();
+#endif
+void updateWC(const TimeSnapshot &now);
+void setRTCFromNtp(const NtpResult &result);
 bool connectedToWifi();
 void connectToWiFi();
-void print2digits(uint8_t number);
+void consoleSync(Print &out, char *args);
+void consoleStats(Print &out, char *args);
+void consoleEffects(Print &out, char *args);
+void consoleGovernor(Print &out, char *args);
+void consoleSettings(Print &out, char *args);
+void consoleBoot(Print &out, char *args);
+void restoreClock();
+void saveClock();
+void bootFrame();
+void loadSettings();
+bool saveSettings();
+void parameterSet(const Parameter &param);
+uint16_t httpRequest(HttpRequest &request, Print &body);
+void httpStatus(Print &out);
+void httpParameters(Print &out);
+bool httpSettings(HttpRequest &request, Print &out);
+void httpRefused(Print &out, const char *error, const char *name);
+void formatLocalTime(const DateTime &time, char *text);
+uint32_t freeRam();
+bool governorChanged();
+void applyGovernor();
+void sendGovernor();
+bool timeZoneChanged();
+bool ntpServerChanged();
+bool transitionChanged();
+bool effectChanged();
+void phraseChanged(const LedMask &from, const LedMask &to);
+
+// Console
+//  Line commands on Serial, replies go out as telemetry text
+const ConsoleCommand consoleCommands[] = {
+    {"sync", "start an NTP sync now", consoleSync},
+    {"stats", "task, telemetry and profile counters", consoleStats},
+    {"effects", "background effects and their cost per frame", consoleEffects},
+    {"governor", "frame rate and quality level", consoleGovernor},
+    {"settings", "stored settings, \"settings save\" writes changes now", consoleSettings},
+    {"boot", "time from boot to a correct display", consoleBoot},
+};
+const Parameter consoleParams[] = {
+    {"tz", PARAM_TEXT, tz_rule, 0, sizeof(tz_rule), timeZoneChanged, false},
+    {"ntp_server", PARAM_TEXT, ntp_server, 0, sizeof(ntp_server), ntpServerChanged, false},
+    {"min_brightness", PARAM_U8, &min_brightness, 0, 255, nullptr, false},
+    {"brightness", PARAM_U8, &brightness, 0, 255, nullptr, true},
+    {"deadline_ms", PARAM_U16, &frame_deadline_ms, MILLIS_FRAME_MIN, 1000, governorChanged, false},
+    {"frame_load", PARAM_U8, &frame_load, 10, 90, governorChanged, false},
+    {"anim_speed", PARAM_U8, &anim_speed, 0, 64, nullptr, false},
+    {"effect", PARAM_U8, &effect, 0, EFFECTS - 1, effectChanged, false},
+    {"hue", PARAM_U8, &effect_hue, 0, 255, nullptr, false},
+    {"transition", PARAM_U8, &transition_style, 0, TRANSITION_STYLES - 1, transitionChanged, false},
+    {"transition_frames", PARAM_U8, &transition_frames, 1, 255, transitionChanged, false},
+};
+const uint8_t CONSOLE_PARAMS = sizeof(consoleParams) / sizeof(consoleParams[0]);
+Console console(Serial, telemetry, consoleCommands, sizeof(consoleCommands) / sizeof(consoleCommands[0]),
+                consoleParams, CONSOLE_PARAMS);
+
+// Parameters kept in flash, by key. Never reuse a key for another parameter.
+const StoredParameter storedParams[] = {
+    {1, "tz"},
+    {2, "min_brightness"},
+    {3, "deadline_ms"},
+    {4, "frame_load"},
+    {5, "anim_speed"},
+    {6, "effect"},
+    {7, "hue"},
+    {8, "transition"},
+    {9, "transition_frames"},
+    {10, "ntp_server"},
+};
+const uint8_t STORED_PARAMS = sizeof(storedParams) / sizeof(storedParams[0]);
+
+// HTTP
+//  GET / is a JSON status document, GET /settings lists the console
+//  parameters and POST /settings sets them from name=value pairs.
+#ifdef WORDCLOCK_NATIVE
+const uint16_t HTTP_PORT = 8080; // No special rights needed on the host
+#else
+const uint16_t HTTP_PORT = 80;
+#endif
+const uint32_t MILLIS_HTTP = 10; // Time in milliseconds between HTTP server steps
+WiFiServer wifiServer(HTTP_PORT);
+HttpServer http(wifiServer, httpRequest);
+bool http_listening = false; // Listening since WiFi last connected
 
 void setup() {
     // Open serial communications and wait for port to open:
@@ -139,716 +265,797 @@ void setup() {
 
     // Start RTC
     rtc.begin();
-    Serial.println("RTC started");
+    telemetry.println("RTC started");
+
+    // Stored settings replace the defaults, and the last good time gets the
+    // clock close before the first sync
+    if (settings.begin())
+    {
+        loadSettings();
+        restoreClock();
+    }
+    else
+    {
+        telemetry.println("Settings flash not available, using defaults");
+    }
+    console.onSet(parameterSet);
+    if (!tz.begin(tz_rule))
+    {
+        telemetry.println("Bad timezone rule, using UTC");
+    }
+
+    // Start sampling brightness in the background
+    ambient.begin(SENSOR_PIN);
 
     // Set up and disable LED strip
+#ifdef WS2812_DMA
+    FastLED.addLeds(&ledController, leds, NUM_LEDS);
+#else
     FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, NUM_LEDS);
+    governor.setWireUs(MICROS_SHOW_WIRE);
+#endif
     FastLED.setMaxPowerInVoltsAndMilliamps(5, 1000);
-    FastLED.setDither(1);
-    for (uint8_t i = 0; i < WC_Y * WC_X; i++)
+    FastLED.setDither(0); // Dithering is done by TemporalDither
+    for (uint16_t i = 0; i < WC_LEDS; i++)
     {
         leds[i] = CRGB::Black;
     }
+    // The reset is a full show, its cost picks the governor's first level
+    uint32_t show_start = micros();
     FastLED.show();
-    Serial.println("LED strip reset");
+    governor.refreshDone(micros() - show_start);
+    telemetry.println("LED strip reset");
 
-    // Initialize LED map
-    CRGBArray<2> wc_led_it;
+#ifdef BENCHMARK_BACKGROUND
+    benchmarkBackground();
+#endif
+
+    // Start the background effect and animate phrase changes
+    effectChanged();
+    transitionChanged();
+    wordLayer.onChanged(phraseChanged);
 
     connectToWiFi();
+    ntp.begin(ntp_server);
+
+    // Rendering is guarded so serial and WiFi work cannot starve it
+    governorChanged();
+    render_task = scheduler.add("render", renderTask, governor.periodMs(), 4);
+    scheduler.guard(render_task);
+    refresh_task = scheduler.add("refresh", refreshTask, governor.refreshMs(), 3);
+    scheduler.add("sensor", sensorTask, MILLIS_SENSOR, 2);
+    wifi_task = scheduler.add("wifi", wifiTask, MILLIS_WIFI_CHECK_BOOT, 1);
+    scheduler.add("ntp", ntpTask, MILLIS_NTP_POLL, 1);
+    scheduler.add("print", printTask, MILLIS_PRINTOUT_TIME, 0);
+    scheduler.add("telemetry", telemetryTask, MILLIS_TELEMETRY, 1);
+    scheduler.add("console", consoleTask, MILLIS_CONSOLE, 1);
+    scheduler.add("settings", settingsTask, MILLIS_SETTINGS_CHECK, 0);
+    scheduler.add("http", httpTask, MILLIS_HTTP, 1);
 
-    Serial.println("Setup Done");
+    telemetry.println("Setup Done");
 }
 
 void loop() {
-    uint64_t millis_loop_start = millis();
+    scheduler.runOnce();
+}
+
+// Tasks
+
+// Render the next frame and show it
+//  The governor gets the cost and may change the frame and refresh periods
+void renderTask()
+{
+    uint32_t start_ms = millis();
+    uint32_t start = micros();
+    readTimeSnapshot(discipline, tz, timeNow);
+
+    // Update background
+    updateBackground();
+
+    // Update Word Clock
+    updateWC(timeNow);
+
+    dither.latch(leds, brightness);
+    refreshTask();
 
-    // Printout current date/time
-    if ((millis_loop_start - millis_time_printout) >= MILLIS_PRINTOUT_TIME)
+    governor.frameDone(start_ms, micros() - start);
+    applyGovernor();
+    if (!boot_reported)
     {
-        printDate();
-        Serial.print(" ");
-        printTime();
-        Serial.println();
-        millis_time_printout = millis_loop_start;
+        bootFrame();
     }
+}
 
-    // Update RTC from WIFI if
-    //  (    RTC has not been set yet
-    //    OR WIFI_REFRESH milliseconds have passed since last time )
-    //  AND WIFI_CONNECTION_WAIT milliseconds have passed since last connection attempt
-    if ((!rtc_set || (millis_loop_start - millis_rtc_update) >= MILLIS_WIFI_REFRESH) && (millis_loop_start - millis_wifi_start_connection) >= MILLIS_WIFI_CONNECTION_WAIT)
+// Refresh the LED strip from the dithered framebuffer
+void refreshTask()
+{
+    uint32_t start = micros();
+    dither.refresh(leds);
     {
-        setRTCFromWiFi();
+        PROFILE_STAGE(PROFILE_SHOW);
+        FastLED.show();
     }
+    governor.refreshDone(micros() - start);
+}
 
-    // Update Word Clock
-    if ((millis_loop_start - millis_wc_update) >= MILLIS_UPDATE_WC)
+// Get brightness from the light sensor
+//  Only picks up the latest averaged ADC result, no conversion wait
+void sensorTask()
+{
+    PROFILE_STAGE(PROFILE_SENSOR);
+    uint16_t adc = ambient.read();
+    brightness = perceptualBrightness(brightnessFilter.update(adc), min_brightness);
+
+    if (abs(brightness - reported_brightness) >= TELEMETRY_BRIGHTNESS_STEP)
     {
-        // Get brightness from potentiometer
-        uint8_t min_brightness = 10;
-        uint8_t brightness = (analogRead(SENSOR_PIN) * (255 - min_brightness)) / 1024 + min_brightness;
-        FastLED.setBrightness(brightness);
+        TelemetryBrightness record = {adc, brightness};
+        telemetry.send(TELEMETRY_BRIGHTNESS, &record, sizeof(record));
+        reported_brightness = brightness;
+    }
+}
 
-        // Update background
-        //  Rainbow walk
-        for (uint16_t y = 0; y < WC_Y; y++)
+// Reconnect WiFi if the connection dropped and WIFI_CONNECTION_WAIT milliseconds
+// have passed since the last attempt, then start a sync if
+//  (    RTC has not been set yet
+//    OR the drift-based sync interval has passed since last time )
+void wifiTask()
+{
+    PROFILE_STAGE(PROFILE_WIFI);
+    uint32_t now = millis();
+    if (!connectedToWifi())
+    {
+        if ((now - millis_wifi_start_connection) >= MILLIS_WIFI_CONNECTION_WAIT)
         {
-            for (uint16_t x = 0; x < WC_X; x++)
-            {
-                // Turn led index into radian
-                float ledNdx_rad = ((float)(ledNdx % 1024)) / 1024 * 2 * 3.14;
-                // Generate offset for grid
-                uint32_t x_offset = x * 8 + WC_X * 32;
-                uint32_t y_offset = y * 8 + WC_Y * 32;
-                // Rotate grid
-                float x_rot = ((float)x_offset) * cos(ledNdx_rad) - ((float)y_offset) * sin(ledNdx_rad);
-                float y_rot = ((float)y_offset) * cos(ledNdx_rad) + ((float)x_offset) * sin(ledNdx_rad);
-                // Convert back to int
-                uint32_t x_rot_int = ((uint32_t)x_rot);
-                uint32_t y_rot_int = ((uint32_t)y_rot);
-                // Update LED array
-                leds[ledMap[y][x]].setHue(inoise16(x_rot_int, y_rot_int));
-                leds[ledMap[y][x]].fadeToBlackBy(192);
-            }
+            connectToWiFi();
         }
-        ledNdx += 1;
+        http_listening = false;
+        return;
+    }
+    if (!boot.connected_ms)
+    {
+        boot.connected_ms = now;
+    }
+    if (!http_listening)
+    {
+        http.begin();
+        http_listening = true;
+    }
+    if ((!discipline.synced() || (now - millis_rtc_update) >= discipline.syncIntervalMs()) && !discipline.syncing())
+    {
+        discipline.startSync();
+    }
+}
 
-        // Update Word Clock
-        updateWC();
+// Step the sync, the RTC keeps running until a reply arrives
+//  The query goes out once an RTC second edge has been timed
+void ntpTask()
+{
+    PROFILE_STAGE(PROFILE_SYNC);
+    discipline.poll();
+    if (discipline.readyToQuery() && !ntp.busy())
+    {
+        ntp.request();
+    }
+    if (ntp.poll())
+    {
+        setRTCFromNtp(ntp.result());
+    }
+}
 
-        FastLED.show();
+// Report the time of the last frame and the frame stats
+void printTask()
+{
+    PROFILE_STAGE(PROFILE_PRINT);
+    TelemetryTime time = {timeNow.utc, timeNow.local, timeNow.dst};
+    telemetry.send(TELEMETRY_TIME, &time, sizeof(time));
+
+    const Task &render = scheduler.task(render_task);
+    const Task &refresh = scheduler.task(refresh_task);
+    TelemetryFrameStats stats = {render.runs, refresh.runs, render.max_us, refresh.max_us,
+                                 render.overruns, telemetry.dropped()};
+    telemetry.send(TELEMETRY_FRAME_STATS, &stats, sizeof(stats));
+    sendGovernor();
+}
+
+// Send queued telemetry as far as Serial takes it without blocking
+void telemetryTask()
+{
+    telemetry.drain();
+}
+
+// Take a few bytes of console input
+void consoleTask()
+{
+    console.poll();
+}
+
+// Move the HTTP client along a few bytes
+void httpTask()
+{
+    http.poll();
+}
+
+// Write changed settings once they have settled, rate limited to spare the flash
+void settingsTask()
+{
+    uint32_t now = millis();
+    if (settings_dirty && now - millis_settings_changed >= MILLIS_SETTINGS_SETTLE &&
+        now - millis_settings_write >= MILLIS_SETTINGS_WRITE)
+    {
+        saveSettings();
+    }
+    if (discipline.synced() && now - millis_clock_save >= MILLIS_CLOCK_SAVE)
+    {
+        saveClock();
+    }
+}
+
+// Background
+
+// Current effect in strip order (see Background.h)
+//  Rendered into its own buffer so frames the governor skips it on can
+//  reuse it under new words. The animation moves anim_speed steps per
+//  MILLIS_ANIM_STEP whatever the frame rate.
+void updateBackground()
+{
+    PROFILE_STAGE(PROFILE_BACKGROUND);
+    if (governor.backgroundDue())
+    {
+        effects.render(background, ledMap.view(), {ledNdx, effect_hue});
+        uint32_t elapsed_ms = (uint32_t)governor.periodMs() * governor.backgroundEvery();
+        uint32_t advance = anim_speed * elapsed_ms + anim_remainder;
+        ledNdx += advance / MILLIS_ANIM_STEP;
+        anim_remainder = advance % MILLIS_ANIM_STEP;
+    }
+    memcpy(leds, background, sizeof(leds));
+}
+
+#ifdef BENCHMARK_BACKGROUND
+// Original float rainbow walk, kept for comparison
+void updateBackgroundFloat(uint32_t step)
+{
+    for (uint16_t y = 0; y < WC_Y; y++)
+    {
+        for (uint16_t x = 0; x < WC_X; x++)
+        {
+            // Turn led index into radian
+            float ledNdx_rad = ((float)(step % 1024)) / 1024 * 2 * 3.14;
+            // Generate offset for grid
+            uint32_t x_offset = x * 8 + WC_X * 32;
+            uint32_t y_offset = y * 8 + WC_Y * 32;
+            // Rotate grid
+            float x_rot = ((float)x_offset) * cos(ledNdx_rad) - ((float)y_offset) * sin(ledNdx_rad);
+            float y_rot = ((float)y_offset) * cos(ledNdx_rad) + ((float)x_offset) * sin(ledNdx_rad);
+            // Convert back to int
+            uint32_t x_rot_int = ((uint32_t)x_rot);
+            uint32_t y_rot_int = ((uint32_t)y_rot);
+            // Update LED array
+            leds[ledMap[y][x]].setHue(inoise16(x_rot_int, y_rot_int));
+            leds[ledMap[y][x]].fadeToBlackBy(192);
+        }
+    }
+}
+
+// Print time per frame for the float kernel and the fixed-point rainbow
+// walk, exact and from a filled noise field. The kernels are called
+// directly, without the effect engine or the governor.
+void benchmarkBackground()
+{
+    const uint32_t frames = 256;
+    static NoiseField<RAINBOW_LATTICE> field;
+    field.begin(rainbowRadius(ledMap.view()));
+    while (field.refresh())
+    {
+    }
+    uint32_t start;
 
-        millis_wc_update = millis_loop_start;
+    start = micros();
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        updateBackgroundFloat(i);
+    }
+    uint32_t float_us = (micros() - start) / frames;
+
+    start = micros();
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        rainbowWalk(leds, ledMap.view(), i);
+    }
+    uint32_t fixed_us = (micros() - start) / frames;
 
-        FastLED.delay(30);
+    start = micros();
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        rainbowWalk(leds, ledMap.view(), i, field);
+    }
+    uint32_t cached_us = (micros() - start) / frames;
+
+    const char *names[] = {"Background float: ", "Background fixed: ", "Background cached: "};
+    const uint32_t us[] = {float_us, fixed_us, cached_us};
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        telemetry.print(names[i]);
+        telemetry.print(us[i]);
+        telemetry.print(" us/frame, ");
+        telemetry.print(us[i] * (F_CPU / 1000000));
+        telemetry.println(" cycles/frame");
     }
 }
+#endif
 
 // Word Clock
 
 // Update the LED mask based on time of day
-void updateWC()
-{
-    // IT
-    setWCWord(WC_IT);
-
-    // IS
-    setWCWord(WC_IS);
-
-    switch (rtc.getMinutes())
-    {
-    case 0 ... 4:
-        // O'CLOCK
-        setWCWord(WC_OCLOCK);
-        break;
-    case 5 ... 9: // Five Past
-        setWCWord(WC_FIVE);
-        setWCWord(WC_PAST);
-        break;
-    case 10 ... 14: // Ten Past
-        setWCWord(WC_TEN);
-        setWCWord(WC_PAST);
-        break;
-    case 15 ... 19: // Quarter Past
-        setWCWord(WC_A);
-        setWCWord(WC_QUARTER);
-        setWCWord(WC_PAST);
-        break;
-    case 20 ... 24: // Twenty Past
-        setWCWord(WC_TWENTY);
-        setWCWord(WC_PAST);
-        break;
-    case 25 ... 29: // Twenty Five Past
-        setWCWord(WC_TWENTY);
-        setWCWord(WC_FIVE);
-        setWCWord(WC_PAST);
-        break;
-    case 30 ... 34: // Half Past
-        setWCWord(WC_HALF);
-        setWCWord(WC_PAST);
-        break;
-    case 35 ... 39: // Twenty Five To
-        setWCWord(WC_TWENTY);
-        setWCWord(WC_FIVE);
-        setWCWord(WC_TO);
-        break;
-    case 40 ... 44: // Twenty To
-        setWCWord(WC_TWENTY);
-        setWCWord(WC_TO);
-        break;
-    case 45 ... 49: // Quarter To
-        setWCWord(WC_A);
-        setWCWord(WC_QUARTER);
-        setWCWord(WC_TO);
-        break;
-    case 50 ... 54: // Ten To
-        setWCWord(WC_TEN);
-        setWCWord(WC_TO);
-        break;
-    case 55 ... 59: // Five To
-        setWCWord(WC_FIVE);
-        setWCWord(WC_TO);
-        break;
-    }
-    // HOURS
-    switch ((((rtc.getMinutes() >= 35) ? 1 : 0) + rtc.getHours() + isDST()) % 12)
-    {
-    case 0:
-        setWCWord(WC_HOUR_TWELVE);
-        break;
-    case 1:
-        setWCWord(WC_HOUR_ONE);
-        break;
-    case 2:
-        setWCWord(WC_HOUR_TWO);
-        break;
-    case 3:
-        setWCWord(WC_HOUR_THREE);
-        break;
-    case 4:
-        setWCWord(WC_HOUR_FOUR);
-        break;
-    case 5:
-        setWCWord(WC_HOUR_FIVE);
-        break;
-    case 6:
-        setWCWord(WC_HOUR_SIX);
-        break;
-    case 7:
-        setWCWord(WC_HOUR_SEVEN);
-        break;
-    case 8:
-        setWCWord(WC_HOUR_EIGHT);
-        break;
-    case 9:
-        setWCWord(WC_HOUR_NINE);
-        break;
-    case 10:
-        setWCWord(WC_HOUR_TEN);
-        break;
-    case 11:
-        setWCWord(WC_HOUR_ELEVEN);
-        break;
-    }
-}
-
-void setWCWord(word_t word)
-{
-
-    switch (word)
-    {
-    case WC_IT:
-        leds[ledMap[0][0]].setRGB(255, 255, 255);
-        leds[ledMap[0][1]].setRGB(255, 255, 255);
-        break;
-    case WC_IS:
-        leds[ledMap[0][3]].setRGB(255, 255, 255);
-        leds[ledMap[0][4]].setRGB(255, 255, 255);
-        break;
-    case WC_A:
-        leds[ledMap[0][8]].setRGB(255, 255, 255);
-        break;
-    case WC_FIVE:
-        leds[ledMap[2][7]].setRGB(255, 255, 255);
-        leds[ledMap[2][8]].setRGB(255, 255, 255);
-        leds[ledMap[2][9]].setRGB(255, 255, 255);
-        leds[ledMap[2][10]].setRGB(255, 255, 255);
-        break;
-    case WC_TEN:
-        leds[ledMap[1][9]].setRGB(255, 255, 255);
-        leds[ledMap[1][10]].setRGB(255, 255, 255);
-        leds[ledMap[1][11]].setRGB(255, 255, 255);
-        break;
-    case WC_QUARTER:
-        leds[ledMap[1][1]].setRGB(255, 255, 255);
-        leds[ledMap[1][2]].setRGB(255, 255, 255);
-        leds[ledMap[1][3]].setRGB(255, 255, 255);
-        leds[ledMap[1][4]].setRGB(255, 255, 255);
-        leds[ledMap[1][5]].setRGB(255, 255, 255);
-        leds[ledMap[1][6]].setRGB(255, 255, 255);
-        leds[ledMap[1][7]].setRGB(255, 255, 255);
-        break;
-    case WC_TWENTY:
-        leds[ledMap[2][0]].setRGB(255, 255, 255);
-        leds[ledMap[2][1]].setRGB(255, 255, 255);
-        leds[ledMap[2][2]].setRGB(255, 255, 255);
-        leds[ledMap[2][3]].setRGB(255, 255, 255);
-        leds[ledMap[2][4]].setRGB(255, 255, 255);
-        leds[ledMap[2][5]].setRGB(255, 255, 255);
-        break;
-    case WC_HALF:
-        leds[ledMap[0][7]].setRGB(255, 255, 255);
-        leds[ledMap[0][8]].setRGB(255, 255, 255);
-        leds[ledMap[0][9]].setRGB(255, 255, 255);
-        leds[ledMap[0][10]].setRGB(255, 255, 255);
-        break;
-    case WC_TO:
-        leds[ledMap[3][5]].setRGB(255, 255, 255);
-        leds[ledMap[3][6]].setRGB(255, 255, 255);
-        break;
-    case WC_PAST:
-        leds[ledMap[3][0]].setRGB(255, 255, 255);
-        leds[ledMap[3][1]].setRGB(255, 255, 255);
-        leds[ledMap[3][2]].setRGB(255, 255, 255);
-        leds[ledMap[3][3]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_ONE:
-        leds[ledMap[3][9]].setRGB(255, 255, 255);
-        leds[ledMap[3][10]].setRGB(255, 255, 255);
-        leds[ledMap[3][11]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_TWO:
-        leds[ledMap[4][9]].setRGB(255, 255, 255);
-        leds[ledMap[4][10]].setRGB(255, 255, 255);
-        leds[ledMap[4][11]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_THREE:
-        leds[ledMap[5][1]].setRGB(255, 255, 255);
-        leds[ledMap[5][2]].setRGB(255, 255, 255);
-        leds[ledMap[5][3]].setRGB(255, 255, 255);
-        leds[ledMap[5][4]].setRGB(255, 255, 255);
-        leds[ledMap[5][5]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_FOUR:
-        leds[ledMap[5][8]].setRGB(255, 255, 255);
-        leds[ledMap[5][9]].setRGB(255, 255, 255);
-        leds[ledMap[5][10]].setRGB(255, 255, 255);
-        leds[ledMap[5][11]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_FIVE:
-        leds[ledMap[6][0]].setRGB(255, 255, 255);
-        leds[ledMap[6][1]].setRGB(255, 255, 255);
-        leds[ledMap[6][2]].setRGB(255, 255, 255);
-        leds[ledMap[6][3]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_SIX:
-        leds[ledMap[6][4]].setRGB(255, 255, 255);
-        leds[ledMap[6][5]].setRGB(255, 255, 255);
-        leds[ledMap[6][6]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_SEVEN:
-        leds[ledMap[7][0]].setRGB(255, 255, 255);
-        leds[ledMap[7][1]].setRGB(255, 255, 255);
-        leds[ledMap[7][2]].setRGB(255, 255, 255);
-        leds[ledMap[7][3]].setRGB(255, 255, 255);
-        leds[ledMap[7][4]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_EIGHT:
-        leds[ledMap[7][7]].setRGB(255, 255, 255);
-        leds[ledMap[7][8]].setRGB(255, 255, 255);
-        leds[ledMap[7][9]].setRGB(255, 255, 255);
-        leds[ledMap[7][10]].setRGB(255, 255, 255);
-        leds[ledMap[7][11]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_NINE:
-        leds[ledMap[6][8]].setRGB(255, 255, 255);
-        leds[ledMap[6][9]].setRGB(255, 255, 255);
-        leds[ledMap[6][10]].setRGB(255, 255, 255);
-        leds[ledMap[6][11]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_TEN:
-        leds[ledMap[8][0]].setRGB(255, 255, 255);
-        leds[ledMap[8][1]].setRGB(255, 255, 255);
-        leds[ledMap[8][2]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_ELEVEN:
-        leds[ledMap[8][4]].setRGB(255, 255, 255);
-        leds[ledMap[8][5]].setRGB(255, 255, 255);
-        leds[ledMap[8][6]].setRGB(255, 255, 255);
-        leds[ledMap[8][7]].setRGB(255, 255, 255);
-        leds[ledMap[8][8]].setRGB(255, 255, 255);
-        leds[ledMap[8][9]].setRGB(255, 255, 255);
-        break;
-    case WC_HOUR_TWELVE:
-        leds[ledMap[4][0]].setRGB(255, 255, 255);
-        leds[ledMap[4][1]].setRGB(255, 255, 255);
-        leds[ledMap[4][2]].setRGB(255, 255, 255);
-        leds[ledMap[4][3]].setRGB(255, 255, 255);
-        leds[ledMap[4][4]].setRGB(255, 255, 255);
-        leds[ledMap[4][5]].setRGB(255, 255, 255);
-        break;
-    case WC_OCLOCK:
-        leds[ledMap[9][2]].setRGB(255, 255, 255);
-        leds[ledMap[9][3]].setRGB(255, 255, 255);
-        leds[ledMap[9][4]].setRGB(255, 255, 255);
-        leds[ledMap[9][5]].setRGB(255, 255, 255);
-        leds[ledMap[9][6]].setRGB(255, 255, 255);
-        leds[ledMap[9][7]].setRGB(255, 255, 255);
-        leds[ledMap[9][8]].setRGB(255, 255, 255);
-        break;
+//  The word layer only rebuilds when the local hour or 5 minute slot changes,
+//  a change plays out as a transition over the next frames
+void updateWC(const TimeSnapshot &now)
+{
+    PROFILE_STAGE(PROFILE_WORDCLOCK);
+    wordLayer.update(now.time.hour, now.time.minute / 5);
+    if (transition.active())
+    {
+        transition.composite(leds);
+    }
+    else
+    {
+        wordLayer.composite(leds);
+    }
+    if (!discipline.synced())
+    {
+        wordLayer.tint(leds, UNVERIFIED_TINT);
     }
 }
 
+// Start animating from the old words to the new ones
+void phraseChanged(const LedMask &from, const LedMask &to)
+{
+    transition.start(from, to);
+}
+
 // RTC Helper Functions
 
-void setRTCFromWiFi()
+void setRTCFromNtp(const NtpResult &result)
 {
-    if (connectedToWifi())
+    if (!discipline.synced())
     {
-        uint32_t epoch;
+        // First sync, the clock can settle to its usual checks
+        boot.error_s = (int32_t)(discipline.now() - result.utc);
+        scheduler.setPeriod(wifi_task, MILLIS_WIFI_CHECK);
+    }
+    discipline.setTime(result);
+    millis_rtc_update = millis();
+    saveClock();
 
-        uint8_t numberOfTries = 0, maxTries = 6;
-        do
-        {
-            epoch = WiFi.getTime();
-            numberOfTries++;
-        } while ((epoch == 0) && (numberOfTries < maxTries));
+    TelemetryClockSync record = {result.utc, (uint16_t)MIN(result.delay_ms, 0xFFFF), discipline.lastOffsetMs(),
+                                 discipline.drift().ppb(), discipline.syncIntervalMs() / 1000, result.stratum};
+    telemetry.send(TELEMETRY_CLOCK_SYNC, &record, sizeof(record));
+}
 
-        if (numberOfTries == maxTries)
-        {
-            Serial.print("NTP unreachable!!");
-            while (1)
-                ;
-        }
-        else
-        {
-            Serial.print("Epoch received: ");
-            Serial.println(epoch);
-            rtc.setEpoch(epoch + GMT * 3600);
-            rtc_set = 1;
-            Serial.println();
-        }
+// WiFi Helper Functions
+
+int resolveHost(const char *host, IPAddress &ip)
+{
+    return WiFi.hostByName(host, ip);
+}
+
+bool connectedToWifi()
+{
+    return WiFi.status() == WL_CONNECTED;
+}
 
-        millis_rtc_update = millis();
+void connectToWiFi()
+{
+    telemetry.print("Attempting to connect to WPA SSID: ");
+    telemetry.println(ssid);
+
+    // Connect to WPA/WPA2 network:
+    WiFi.begin(ssid, pass);
+
+    millis_wifi_start_connection = millis();
+}
+
+// Console Commands
+
+void consoleSync(Print &out, char *)
+{
+    if (!connectedToWifi())
+    {
+        out.println("WiFi not connected");
+        return;
     }
-    else
+    if (!discipline.syncing())
     {
-        connectToWiFi();
+        discipline.startSync();
     }
+    out.println("Sync started");
 }
 
-uint32_t isDST()
+void consoleStats(Print &out, char *)
 {
+    for (uint8_t i = 0; i < scheduler.count(); i++)
+    {
+        const Task &task = scheduler.task(i);
+        out.print(task.name);
+        out.print(" runs ");
+        out.print(task.runs);
+        out.print(" max ");
+        out.print(task.max_us);
+        out.print(" us overruns ");
+        out.println(task.overruns);
+    }
+    out.print("telemetry sent ");
+    out.print(telemetry.sent());
+    out.print(" dropped ");
+    out.println(telemetry.dropped());
+#ifdef WORDCLOCK_PROFILE
+    profileDump(out);
+#endif
+}
 
-    // Second Sunday in March at 2:00	First Sunday in November at 2:00
+void consoleEffects(Print &out, char *)
+{
+    effects.dump(out);
+}
 
-    // Not daylight savings if before Mar or after Nov
-    if (rtc.getMonth() < 3 || rtc.getMonth() > 11)
+void consoleGovernor(Print &out, char *)
+{
+    governor.dump(out);
+}
+
+void consoleSettings(Print &out, char *args)
+{
+    if (strcmp(args, "save") == 0)
+    {
+        out.println(saveSettings() ? "Settings saved" : "Settings not saved");
+    }
+    settings.dump(out);
+    if (settings_dirty)
     {
-        return 0;
+        out.println("changes not saved yet");
     }
+}
 
-    // Daylight savings if after Mar and before Nov
-    if (rtc.getMonth() > 3 && rtc.getMonth() < 11)
+void consoleBoot(Print &out, char *)
+{
+    if (boot.restored)
+    {
+        out.print("saved time, up to ");
+        out.print(boot.stale_max_s);
+        out.print(" s behind plus the time off");
+    }
+    else
+    {
+        out.print("RTC time");
+    }
+    out.print(", first frame ");
+    out.print(boot.first_frame_ms);
+    out.print(" ms, WiFi ");
+    out.print(boot.connected_ms);
+    out.println(" ms");
+    if (!boot_reported)
     {
-        return 1;
+        out.println("time not verified yet");
+        return;
     }
+    out.print("correct time ");
+    out.print(boot.verified_ms);
+    out.print(" ms, was ");
+    out.print(boot.error_s);
+    out.println(" s off");
+}
+
+// HTTP Helper Functions
 
-    // If after second sunday in march
-    // Second sunday if day >7 and <=14 and sunday
-    if (rtc.getMonth() == 3)
+// Answer one request, the server writes out the body
+uint16_t httpRequest(HttpRequest &request, Print &body)
+{
+    if (strcmp(request.path, "/") == 0 || strcmp(request.path, "/status") == 0)
     {
-        // Past second week
-        if (rtc.getDay() > 14)
-        {
-            return 1;
-        }
-        // Second week
-        if (rtc.getDay() == 14)
-        {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Past 2:00
-                if (rtc.getHours() >= 2)
-                {
-                    return 1;
-                }
-            }
-            // Past Sunday
-            if (dayOfWeek() <= 6)
-            {
-                return 1;
-            }
-        }
-        if (rtc.getDay() == 13)
-        {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Past 2:00
-                if (rtc.getHours() >= 2)
-                {
-                    return 1;
-                }
-            }
-            // Past Sunday
-            if (dayOfWeek() <= 5)
-            {
-                return 1;
-            }
-        }
-        if (rtc.getDay() == 12)
+        if (request.method != HTTP_GET)
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Past 2:00
-                if (rtc.getHours() >= 2)
-                {
-                    return 1;
-                }
-            }
-            // Past Sunday
-            if (dayOfWeek() <= 4)
-            {
-                return 1;
-            }
+            return 405;
         }
-        if (rtc.getDay() == 11)
+        httpStatus(body);
+        return 200;
+    }
+    if (strcmp(request.path, "/settings") == 0)
+    {
+        if (request.method == HTTP_OTHER)
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Past 2:00
-                if (rtc.getHours() >= 2)
-                {
-                    return 1;
-                }
-            }
-            // Past Sunday
-            if (dayOfWeek() <= 3)
-            {
-                return 1;
-            }
+            return 405;
         }
-        if (rtc.getDay() == 10)
+        if (request.method == HTTP_POST && !httpSettings(request, body))
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Past 2:00
-                if (rtc.getHours() >= 2)
-                {
-                    return 1;
-                }
-            }
-            // Past Sunday
-            if (dayOfWeek() <= 2)
-            {
-                return 1;
-            }
+            return 400;
         }
-        if (rtc.getDay() == 9)
+        httpParameters(body);
+        return 200;
+    }
+    return 404;
+}
+
+void httpStatus(Print &out)
+{
+    char local[20];
+    formatLocalTime(timeNow.time, local);
+    const Task &render = scheduler.task(render_task);
+    uint32_t now = millis();
+
+    JsonObject status(out);
+    status.addUint("utc", timeNow.utc);
+    status.addText("local", local);
+    status.addBool("dst", timeNow.dst);
+    status.addBool("synced", discipline.synced());
+    status.addInt("last_sync_s", discipline.synced() ? (int32_t)((now - millis_rtc_update) / 1000) : -1);
+    status.addUint("sync_interval_s", discipline.syncIntervalMs() / 1000);
+    status.addInt("drift_ppb", discipline.drift().ppb());
+    status.addInt("last_offset_ms", discipline.lastOffsetMs());
+    status.addUint("frames", render.runs);
+    status.addUint("frame_max_us", render.max_us);
+    status.addUint("frame_us", governor.frameUs());
+    status.addUint("refresh_us", governor.refreshUs());
+    status.addUint("period_ms", governor.periodMs());
+    status.addUint("level", governor.level());
+    status.addUint("missed", governor.missed());
+    status.addUint("brightness", brightness);
+    status.addUint("free_ram", freeRam());
+    status.addUint("uptime_s", now / 1000);
+    status.end();
+}
+
+void httpParameters(Print &out)
+{
+    JsonObject params(out);
+    for (uint8_t i = 0; i < CONSOLE_PARAMS; i++)
+    {
+        const Parameter &param = consoleParams[i];
+        if (param.type == PARAM_TEXT)
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Past 2:00
-                if (rtc.getHours() >= 2)
-                {
-                    return 1;
-                }
-            }
-            // Past Sunday
-            if (dayOfWeek() <= 1)
-            {
-                return 1;
-            }
+            params.addText(param.name, (const char *)param.value);
         }
-        if (rtc.getDay() == 8)
+        else
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Past 2:00
-                if (rtc.getHours() >= 2)
-                {
-                    return 1;
-                }
-            }
+            params.addUint(param.name, parameterNumber(param));
         }
-        return 0;
     }
+    params.end();
+}
 
-    // If before first sunday in nov
-    // Second sunday if day <= 7 and sunday
-    if (rtc.getMonth() == 11)
+// Set parameters from the form body as the console would, all or none.
+//  Every pair is checked before any is set. If a changed() hook still
+//  refuses one, those already set get their previous values back.
+bool httpSettings(HttpRequest &request, Print &out)
+{
+    const Parameter *params[CONSOLE_PARAMS];
+    const char *values[CONSOLE_PARAMS];
+    uint8_t count = 0;
+    char *cursor = request.body;
+    char *name;
+    char *value;
+    while (httpFormNext(cursor, name, value))
     {
-        // First week
-        if (rtc.getDay() == 7)
+        const Parameter *param = findParameter(consoleParams, CONSOLE_PARAMS, name);
+        const char *error = !param                          ? "Unknown parameter"
+                            : count == CONSOLE_PARAMS       ? "Too many parameters"
+                            : !checkParameter(*param, value) ? "Cannot set"
+                                                             : nullptr;
+        if (error)
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Before 2:00
-                if (rtc.getHours() < 2)
-                {
-                    return 1;
-                }
-            }
-            // Before Sunday
-            if (dayOfWeek() < 1)
-            {
-                return 1;
-            }
+            httpRefused(out, error, name);
+            return false;
         }
-        if (rtc.getDay() == 6)
+        params[count] = param;
+        values[count++] = value;
+    }
+
+    uint8_t previous[CONSOLE_PARAMS][SETTINGS_VALUE_MAX];
+    uint8_t lengths[CONSOLE_PARAMS];
+    for (uint8_t i = 0; i < count; i++)
+    {
+        lengths[i] = parameterBytes(*params[i], previous[i], SETTINGS_VALUE_MAX);
+        if (!setParameter(*params[i], values[i]))
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Before 2:00
-                if (rtc.getHours() < 2)
-                {
-                    return 1;
-                }
-            }
-            // Before Sunday
-            if (dayOfWeek() >= 6)
+            httpRefused(out, "Cannot set", params[i]->name);
+            while (i-- > 0)
             {
-                return 1;
+                setParameterBytes(*params[i], previous[i], lengths[i]);
             }
+            return false;
         }
-        if (rtc.getDay() == 5)
-        {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Before 2:00
-                if (rtc.getHours() < 2)
-                {
-                    return 1;
-                }
-            }
-            // Before Sunday
-            if (dayOfWeek() >= 5)
-            {
-                return 1;
-            }
-        }
-        if (rtc.getDay() == 4)
+    }
+    for (uint8_t i = 0; i < count; i++)
+    {
+        parameterSet(*params[i]);
+    }
+    return true;
+}
+
+void httpRefused(Print &out, const char *error, const char *name)
+{
+    JsonObject refused(out);
+    refused.addText("error", error);
+    refused.addText("parameter", name);
+    refused.end();
+}
+
+// "YYYY-MM-DD hh:mm:ss", text holds 20 bytes
+void formatLocalTime(const DateTime &time, char *text)
+{
+    const uint8_t fields[] = {(uint8_t)(time.year / 100), (uint8_t)(time.year % 100), time.month, time.day,
+                              time.hour, time.minute, time.second};
+    const char separators[] = "\0-- ::";
+    for (uint8_t i = 0; i < sizeof(fields); i++)
+    {
+        if (i > 0 && separators[i - 1])
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Before 2:00
-                if (rtc.getHours() < 2)
-                {
-                    return 1;
-                }
-            }
-            // Before Sunday
-            if (dayOfWeek() >= 4)
-            {
-                return 1;
-            }
+            *text++ = separators[i - 1];
         }
-        if (rtc.getDay() == 3)
+        *text++ = '0' + fields[i] / 10;
+        *text++ = '0' + fields[i] % 10;
+    }
+    *text = '\0';
+}
+
+// Bytes between the heap and the stack
+uint32_t freeRam()
+{
+#if defined(ARDUINO_ARCH_SAMD)
+    char top;
+    return &top - sbrk(0);
+#else
+    return 0; // Not meaningful on the host
+#endif
+}
+
+// Boot Helper Functions
+
+// Start from the time saved while synced, unless the RTC kept a later one.
+// The saved time can be a whole save interval old, besides the time off.
+void restoreClock()
+{
+    RtcState state;
+    if (settings.read(SETTINGS_KEY_CLOCK, &state, sizeof(state)) == sizeof(state))
+    {
+        boot.restored = discipline.restore(state);
+        boot.stale_max_s = boot.restored ? MILLIS_CLOCK_SAVE / 1000 : 0;
+    }
+}
+
+void saveClock()
+{
+    RtcState state = discipline.state();
+    settings.write(SETTINGS_KEY_CLOCK, &state, sizeof(state));
+    millis_clock_save = millis();
+}
+
+// Time the first frame, then the first one showing synced time
+void bootFrame()
+{
+    if (!boot_first_frame)
+    {
+        boot.first_frame_ms = millis();
+        boot_first_frame = true;
+    }
+    if (discipline.synced())
+    {
+        boot.verified_ms = millis();
+        boot_reported = true;
+        telemetry.send(TELEMETRY_BOOT, &boot, sizeof(boot));
+    }
+}
+
+// Settings Helper Functions
+
+// Stored values go through the parameters' own checks, one that is refused
+// leaves the default
+void loadSettings()
+{
+    for (uint8_t i = 0; i < STORED_PARAMS; i++)
+    {
+        const Parameter *param = findParameter(consoleParams, CONSOLE_PARAMS, storedParams[i].name);
+        uint8_t value[SETTINGS_VALUE_MAX];
+        uint8_t len = settings.read(storedParams[i].key, value, sizeof(value));
+        if (param && len && !setParameterBytes(*param, value, len))
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Before 2:00
-                if (rtc.getHours() < 2)
-                {
-                    return 1;
-                }
-            }
-            // Before Sunday
-            if (dayOfWeek() >= 3)
-            {
-                return 1;
-            }
+            telemetry.print("Stored ");
+            telemetry.print(param->name);
+            telemetry.println(" refused, using the default");
         }
-        if (rtc.getDay() == 2)
+    }
+}
+
+// Write every stored parameter, the store skips the ones that did not change
+bool saveSettings()
+{
+    bool saved = true;
+    for (uint8_t i = 0; i < STORED_PARAMS; i++)
+    {
+        const Parameter *param = findParameter(consoleParams, CONSOLE_PARAMS, storedParams[i].name);
+        uint8_t value[SETTINGS_VALUE_MAX];
+        uint8_t len = param ? parameterBytes(*param, value, sizeof(value)) : 0;
+        if (param && !settings.write(storedParams[i].key, value, len))
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Before 2:00
-                if (rtc.getHours() < 2)
-                {
-                    return 1;
-                }
-            }
-            // Before Sunday
-            if (dayOfWeek() >= 2)
-            {
-                return 1;
-            }
+            saved = false;
         }
-        if (rtc.getDay() == 1)
+    }
+    millis_settings_write = millis();
+    settings_dirty = !saved;
+    if (!saved)
+    {
+        telemetry.println("Settings write failed");
+    }
+    return saved;
+}
+
+// Note changes to stored parameters for settingsTask()
+void parameterSet(const Parameter &param)
+{
+    for (uint8_t i = 0; i < STORED_PARAMS; i++)
+    {
+        if (strcmp(storedParams[i].name, param.name) == 0)
         {
-            // Is Sunday
-            if (dayOfWeek() == 0)
-            {
-                // Before 2:00
-                if (rtc.getHours() < 2)
-                {
-                    return 1;
-                }
-            }
-            // Before Sunday
-            if (dayOfWeek() >= 1)
-            {
-                return 1;
-            }
+            settings_dirty = true;
+            millis_settings_changed = millis();
         }
-        return 0;
     }
-    return 0;
 }
 
-uint32_t dayOfWeek()
+bool governorChanged()
 {
-
-    uint32_t seconds_per_day = 86400;
-    uint32_t epoch_start_day_offset = 4; // Adjust for start day being thursday
-    return ((rtc.getEpoch() / seconds_per_day) + epoch_start_day_offset) % 7;
+    governor.configure(frame_deadline_ms, MILLIS_FRAME_MIN, frame_load);
+    applyGovernor();
+    return true;
 }
 
-void printTime()
+// Follow the governor's periods, and report when its level moves
+void applyGovernor()
 {
-    print2digits(rtc.getHours());
-    Serial.print(":");
-    print2digits(rtc.getMinutes());
-    Serial.print(":");
-    print2digits(rtc.getSeconds());
-    Serial.println();
+    static uint8_t reported_level = 0;
+    if (render_task >= 0 && scheduler.task(render_task).period_ms != governor.periodMs())
+    {
+        scheduler.setPeriod(render_task, governor.periodMs());
+    }
+    if (refresh_task >= 0 && scheduler.task(refresh_task).period_ms != governor.refreshMs())
+    {
+        scheduler.setPeriod(refresh_task, governor.refreshMs());
+    }
+    if (governor.level() != reported_level)
+    {
+        reported_level = governor.level();
+        sendGovernor();
+    }
 }
 
-void printDate()
+void sendGovernor()
 {
-    Serial.print(isDST());
-    Serial.print(" ");
-    Serial.print(dayOfWeek());
-    Serial.print(" ");
-    Serial.print(rtc.getEpoch());
-    Serial.print(" ");
-    Serial.print(rtc.getMonth());
-    Serial.print("/");
-    Serial.print(rtc.getDay());
-    Serial.print("/");
-    Serial.print(rtc.getYear());
-    Serial.print(" ");
+    TelemetryGovernor record = {governor.level(), governor.periodMs(), governor.refreshMs(),
+                                governor.frameUs(), governor.refreshUs(), governor.missed()};
+    telemetry.send(TELEMETRY_GOVERNOR, &record, sizeof(record));
 }
 
-// WiFi Helper Functions
-
-bool connectedToWifi()
+bool timeZoneChanged()
 {
-    return WiFi.status() == WL_CONNECTED;
+    return tz.begin(tz_rule);
 }
 
-void connectToWiFi()
+// A new server is looked up on the next query
+bool ntpServerChanged()
 {
-    Serial.print("Attempting to connect to WPA SSID: ");
-    Serial.println(ssid);
-
-    // Connect to WPA/WPA2 network:
-    WiFi.begin(ssid, pass);
+    if (!ntp_server[0])
+    {
+        return false;
+    }
+    ntp.begin(ntp_server);
+    return true;
+}
 
-    millis_wifi_start_connection = millis();
+bool transitionChanged()
+{
+    transition.configure((transition_style_t)transition_style, transition_frames);
+    return true;
 }
 
-// General Helper Functions
-void print2digits(uint8_t number)
+bool effectChanged()
 {
-    if (number < 10)
-    {
-        Serial.print("0");
-    }
-    Serial.print(number);
-}
\ No newline at end of file
+    return effects.select(effect, ledMap.view());
+}
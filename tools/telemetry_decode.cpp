@@ -0,0 +1,244 @@
+// Decode the word clock's telemetry stream into readable log lines
+//
+//  g++ -std=gnu++14 -O2 -Iinclude tools/telemetry_decode.cpp -o telemetry_decode
+//  stty -F /dev/ttyACM0 raw 115200 && ./telemetry_decode /dev/ttyACM0
+//  .pio/build/native/program | ./telemetry_decode
+//
+// Reads a file or device, or stdin when none is given. Bytes outside valid
+// frames are passed through as text, so a stream picked up mid-record or
+// mixed with plain prints still decodes. Frames from a newer firmware are
+// still read, and the summary says the decoder is out of date.
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "TelemetryFormat.h"
+
+struct DecodeStats
+{
+    uint32_t records;
+    uint32_t bad_frames; // Magic byte seen but no valid frame behind it
+    uint32_t unknown;    // Valid frames of a type this decoder does not know
+    uint32_t newer;      // Valid frames of a later format version
+    uint8_t version;     // Latest version seen
+};
+
+static void printEpoch(uint32_t epoch)
+{
+    time_t t = epoch;
+    struct tm fields;
+    gmtime_r(&t, &fields);
+    printf("%04d-%02d-%02d %02d:%02d:%02d", fields.tm_year + 1900, fields.tm_mon + 1, fields.tm_mday,
+           fields.tm_hour, fields.tm_min, fields.tm_sec);
+}
+
+// Payloads are little endian like the host, and the structs are packed
+template <typename T>
+static bool readPayload(const uint8_t *payload, uint8_t length, T &record)
+{
+    if (length < sizeof(T))
+    {
+        return false;
+    }
+    memcpy(&record, payload, sizeof(T));
+    return true;
+}
+
+// Text passes straight through, everything else is one line per record
+static bool printRecord(uint8_t type, uint32_t ms, const uint8_t *payload, uint8_t length)
+{
+    if (type == TELEMETRY_TEXT)
+    {
+        fwrite(payload, 1, length, stdout);
+        return true;
+    }
+
+    printf("[%10" PRIu32 " ms] ", ms);
+    switch (type)
+    {
+    case TELEMETRY_TIME:
+    {
+        TelemetryTime record;
+        if (!readPayload(payload, length, record))
+        {
+            return false;
+        }
+        printf("time ");
+        printEpoch(record.local);
+        printf(" local%s, utc %" PRIu32 "\n", record.dst ? " DST" : "", record.utc);
+        return true;
+    }
+    case TELEMETRY_CLOCK_SYNC:
+    {
+        TelemetryClockSync record;
+        if (!readPayload(payload, length, record))
+        {
+            return false;
+        }
+        printf("sync ");
+        printEpoch(record.utc);
+        printf(" UTC stratum %u delay %u ms offset %" PRId32 " ms drift %" PRId32 " ppb next sync %" PRIu32 " s\n",
+               record.stratum, record.delay_ms, record.offset_ms, record.drift_ppb, record.next_s);
+        return true;
+    }
+    case TELEMETRY_BRIGHTNESS:
+    {
+        TelemetryBrightness record;
+        if (!readPayload(payload, length, record))
+        {
+            return false;
+        }
+        printf("brightness %u (adc %u)\n", record.brightness, record.adc);
+        return true;
+    }
+    case TELEMETRY_FRAME_STATS:
+    {
+        TelemetryFrameStats record;
+        if (!readPayload(payload, length, record))
+        {
+            return false;
+        }
+        printf("frames %" PRIu32 " (max %" PRIu32 " us, %" PRIu32 " overruns) refreshes %" PRIu32
+               " (max %" PRIu32 " us) telemetry dropped %" PRIu32 "\n",
+               record.frames, record.render_max_us, record.overruns, record.refreshes, record.refresh_max_us,
+               record.dropped);
+        return true;
+    }
+    case TELEMETRY_GOVERNOR:
+    {
+        TelemetryGovernor record;
+        if (!readPayload(payload, length, record))
+        {
+            return false;
+        }
+        printf("governor level %u period %u ms refresh %u ms, frame %" PRIu32 " us refresh %" PRIu32
+               " us, %" PRIu32 " missed deadlines\n",
+               record.level, record.period_ms, record.refresh_ms, record.frame_us, record.refresh_us, record.missed);
+        return true;
+    }
+    case TELEMETRY_BOOT_V3:
+    {
+        TelemetryBootV3 record;
+        if (!readPayload(payload, length, record))
+        {
+            return false;
+        }
+        printf("boot: %s time, first frame %" PRIu32 " ms, WiFi %" PRIu32 " ms, correct time %" PRIu32
+               " ms, was %" PRId32 " s off\n",
+               record.restored ? "saved" : "RTC", record.first_frame_ms, record.connected_ms, record.verified_ms,
+               record.error_s);
+        return true;
+    }
+    case TELEMETRY_BOOT:
+    {
+        TelemetryBoot record;
+        if (!readPayload(payload, length, record))
+        {
+            return false;
+        }
+        if (record.restored)
+        {
+            printf("boot: saved time, up to %" PRIu32 " s behind plus the time off", record.stale_max_s);
+        }
+        else
+        {
+            printf("boot: RTC time");
+        }
+        printf(", first frame %" PRIu32 " ms, WiFi %" PRIu32 " ms, correct time %" PRIu32 " ms, was %" PRId32
+               " s off\n",
+               record.first_frame_ms, record.connected_ms, record.verified_ms, record.error_s);
+        return true;
+    }
+    default:
+        printf("unknown record type %u, %u bytes\n", type, length);
+        return false;
+    }
+}
+
+// Bytes that may still become a frame, frame[0] is always the magic byte
+static uint8_t frame[TELEMETRY_MAX_RECORD];
+static uint16_t frameLength = 0;
+static DecodeStats stats = {};
+
+static void feed(uint8_t c)
+{
+    if (frameLength == 0)
+    {
+        if (c == TELEMETRY_MAGIC)
+        {
+            frame[frameLength++] = c;
+        }
+        else
+        {
+            putchar(c);
+        }
+        return;
+    }
+    frame[frameLength++] = c;
+
+    // Header checks as soon as the bytes are in
+    bool bad = (frameLength == 2 && frame[1] == 0) ||
+               (frameLength == 4 && frame[3] > TELEMETRY_MAX_PAYLOAD);
+    if (!bad && frameLength >= TELEMETRY_HEADER_SIZE && frameLength == TELEMETRY_HEADER_SIZE + frame[3] + 1)
+    {
+        if (telemetryCrc(0, frame + 1, frameLength - 2) == frame[frameLength - 1])
+        {
+            uint32_t ms = frame[4] | (uint32_t)frame[5] << 8 | (uint32_t)frame[6] << 16 | (uint32_t)frame[7] << 24;
+            if (!printRecord(frame[2], ms, frame + TELEMETRY_HEADER_SIZE, frame[3]))
+            {
+                stats.unknown++;
+            }
+            if (frame[1] > TELEMETRY_VERSION)
+            {
+                stats.newer++;
+                stats.version = frame[1] > stats.version ? frame[1] : stats.version;
+            }
+            stats.records++;
+            frameLength = 0;
+            return;
+        }
+        bad = true;
+    }
+    if (bad)
+    {
+        // Not a frame after all, pass the magic byte through and rescan the rest
+        stats.bad_frames++;
+        uint8_t rest[TELEMETRY_MAX_RECORD];
+        uint16_t rest_length = frameLength - 1;
+        memcpy(rest, frame + 1, rest_length);
+        putchar(frame[0]);
+        frameLength = 0;
+        for (uint16_t i = 0; i < rest_length; i++)
+        {
+            feed(rest[i]);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    if (argc > 1 && !(in = fopen(argv[1], "rb")))
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    int c;
+    while ((c = fgetc(in)) != EOF)
+    {
+        feed(c);
+    }
+
+    fprintf(stderr, "%" PRIu32 " records, %" PRIu32 " bad frames, %" PRIu32 " unknown\n",
+            stats.records, stats.bad_frames, stats.unknown);
+    if (stats.newer)
+    {
+        fprintf(stderr, "%" PRIu32 " records in format version %u, this decoder knows up to %u, rebuild it\n",
+                stats.newer, stats.version, TELEMETRY_VERSION);
+    }
+    return 0;
+}